@@ -1,37 +1,64 @@
 #pragma once
 
+#include <my/format/format.hpp>
 #include <my/format/repr.hpp>
+//
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 namespace my {
 
+/**
+ * @brief Emits literal segments of compiled format around values printed
+ * one at a time, values take argument slots in order together with their
+ * specs
+ *
+ */
 template <class Ch, class Tr>
 struct FormatEmitter {
     explicit FormatEmitter(const Ch* fmt)
-        : _fmt(fmt) {
+        : _format(std::make_shared<const basic_compiled_format<Ch>>(fmt)) {
     }
 
-    constexpr auto tail(std::basic_ostream<Ch, Tr>& os) const {
-        for (; !Tr::eq(*_fmt, '\0'); ++_fmt) {
-            if (Tr::eq(*_fmt, '{') and
-                Tr::eq(*(_fmt + 1), '}')) {
-                return true;
-            }
-            os << *_fmt;
+    /**
+     * @brief Prints literal text up to the next argument slot
+     *
+     * @return true if there is a slot for the next value
+     */
+    auto tail(std::basic_ostream<Ch, Tr>& os) const {
+        if (not _written and _slot <= _format->size()) {
+            const auto segment = _format->segment(_slot);
+            os.write(segment.data(), segment.size());
+            _written = true;
         }
-        return false;
+        return _slot < _format->size();
     }
 
-    constexpr auto operator()(std::basic_ostream<Ch, Tr>& os) const {
+    /**
+     * @brief Prints literal text up to the next argument slot and takes it
+     *
+     * @return true if value should be printed now
+     */
+    auto operator()(std::basic_ostream<Ch, Tr>& os) const {
         if (tail(os)) {
-            _fmt += 2;
+            ++_slot;
+            _written = false;
             return true;
         }
         return false;
     }
 
+    /**
+     * @return Spec of the slot taken last
+     */
+    const format_spec& spec() const { return _format->spec(_slot - 1); }
+
    private:
-    using str = const Ch*;
-    mutable str _fmt;
+    // shared, so copies of closure do not copy parsed format
+    std::shared_ptr<const basic_compiled_format<Ch>> _format;
+    mutable size_t _slot = 0;
+    mutable bool _written = false;
 };
 
 template <class Representer, class Emitter>
@@ -48,11 +75,43 @@ struct FormatRepresenter
               my::representable_with<Representer, std::basic_ostream<Ch, Tr>> T>
     constexpr void operator()(std::basic_ostream<Ch, Tr>& os,
                               const T& value) const {
-        if (_emitter(os)) _represent(os, value);
+        if (_emitter(os)) _print(os, value, _emitter.spec());
         _emitter.tail(os);
     }
 
    private:
+    // numbers are formatted as by my::format, anything else is represented
+    // and then padded, so only fill, align and width apply to it
+    template <class Ch, class Tr, class T>
+    void _print(std::basic_ostream<Ch, Tr>& os, const T& value,
+                const format_spec& spec) const {
+        if (spec.empty()) {
+            _represent(os, value);
+            return;
+        }
+
+        auto buffer = std::exchange(detail::_formatBuffer<Ch>(), {});
+        buffer.clear();
+        if constexpr (std::is_arithmetic_v<T>) {
+            detail::_checkSpec<Ch, T>(spec);
+            detail::_formatArg(buffer, value, spec);
+        } else {
+            if (spec.type != '\0' or spec.sign != '\0' or spec.alternate or
+                spec.zero or spec.precision >= 0) {
+                detail::_formatError("Only fill, align and width are "
+                                     "allowed for printable types");
+            }
+            {
+                detail::_StringAppendBuf<Ch> append(buffer);
+                std::basic_ostream<Ch> stream(&append);
+                _represent(stream, value);
+            }
+            detail::_pad(buffer, 0, spec, '<', buffer.npos);
+        }
+        detail::_write(os, buffer);
+        detail::_formatBuffer<Ch>() = std::move(buffer);
+    }
+
     Emitter _emitter;
     Representer _represent;
 };
@@ -1,8 +1,23 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <my/format/format.hpp>
 #include <my/util/defs.hpp>
+#include <my/util/statistics.hpp>
+#include <type_traits>
+#include <vector>
+
+#if defined(MY_TIMEIT_TSC) && \
+    (defined(__x86_64__) || defined(__i386__) || defined(_M_X64))
+#define MY_TIMEIT_USE_TSC 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#elif defined(MY_TIMEIT_USE_TSC)
+#include <x86intrin.h>
+#endif
 
 /**
  * @brief dirty debugging macro
@@ -10,48 +25,218 @@
  * #Example:
  * auto a = 10 + dbg(2 * 3); // may print: [c:\dev\main.cpp:8] 2 * 3 = 6
  *
+ * @note lvalues are passed through by reference, temporaries by value
  */
 #if defined(NDEBUG)
 #define dbg(expr) (expr)
 #else
-#define dbg(expr) ([]() {                                \
-    const auto _dbg_tmp = (expr);                        \
-    my::printf(std::cerr, "[{}:{}] {} = {}\n",           \
-               __FILENAME__, __LINE__, #expr, _dbg_tmp); \
-    return _dbg_tmp;                                     \
-}())
+#define dbg(expr) \
+    my::detail::_dbg(__FILENAME__, __LINE__, #expr, (expr))
+#endif
+
+namespace my {
+
+/**
+ * @brief Makes compiler assume value is read, so computation of the value
+ * can not be removed as unused
+ *
+ * @param value value to keep
+ */
+template <class T>
+inline void doNotOptimize(const T& value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    const volatile char* sink = &reinterpret_cast<const volatile char&>(value);
+    (void)*sink;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+/**
+ * @brief Makes compiler assume all memory is read and written here,
+ * so stores before it can not be removed or moved past it
+ *
+ */
+inline void clobberMemory() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : : "memory");
 #endif
+}
+
+struct BenchmarkOptions {
+    std::chrono::nanoseconds warmup = std::chrono::milliseconds(50);
+    std::chrono::nanoseconds sampleTime = std::chrono::milliseconds(2);
+    size_t samples = 50;
+};
 
 /**
- * @brief simple timing macro for measuring and printing
- * time of execution of provided expression
+ * @brief Timings of my::benchmark, in nanoseconds per iteration
+ *
+ */
+struct BenchmarkResult {
+    size_t iterations = 0;        // iterations per sample
+    std::vector<double> samples;  // sorted
+    double min = 0;
+    double median = 0;
+    double p99 = 0;
+    double mean = 0;
+    double stddev = 0;
+};
+
+namespace detail {
+
+// function instead of lambda, so dbg works outside of function bodies too
+template <class T>
+T _dbg(const char* file, int line, const char* expr, T&& value) {
+    my::printf(std::cerr, "[{}:{}] {} = {}\n", file, line, expr, value);
+    return std::forward<T>(value);
+}
+
+/**
+ * @brief Clock of benchmarks, std::chrono::steady_clock or, with
+ * MY_TIMEIT_TSC defined on x86, time stamp counter calibrated against it
+ *
+ */
+struct _BenchClock {
+#if defined(MY_TIMEIT_USE_TSC)
+    static double now() noexcept {
+        static const double nsPerTick = _calibrate();
+        return static_cast<double>(__rdtsc()) * nsPerTick;
+    }
+
+   private:
+    static double _calibrate() {
+        using namespace std::chrono;
+        const auto start = steady_clock::now();
+        const auto ticks = __rdtsc();
+        while (steady_clock::now() - start < milliseconds(20)) {
+        }
+        const double ns = duration<double, std::nano>(
+                              steady_clock::now() - start)
+                              .count();
+        return ns / static_cast<double>(__rdtsc() - ticks);
+    }
+#else
+    static double now() noexcept {
+        using namespace std::chrono;
+        return duration<double, std::nano>(
+                   steady_clock::now().time_since_epoch())
+            .count();
+    }
+#endif
+};
+
+template <class F>
+double _runBatch(F& fn, size_t iterations) {
+    const double start = _BenchClock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        if constexpr (std::is_void_v<std::invoke_result_t<F&>>) {
+            fn();
+        } else {
+            doNotOptimize(fn());
+        }
+        clobberMemory();
+    }
+    return _BenchClock::now() - start;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Measures function in samples of many calls.
+ * Function is warmed up first, then number of calls per sample is doubled
+ * until sample lasts options.sampleTime, so clock resolution and overhead
+ * become negligible. Result of every call is kept with my::doNotOptimize
+ * and memory is clobbered between calls, thus measured work is not
+ * removed or hoisted out of the loop by optimizer.
+ *
+ * #Example:
+ * auto result = my::benchmark([&] { return std::hash<std::string>{}(s); });
+ * my::printf("{:.1f} ns\n", result.median);
+ *
+ * @param fn function to measure
+ * @param options warm-up and sampling settings
+ * @return BenchmarkResult nanoseconds per call statistics over samples
+ */
+template <std::invocable F>
+BenchmarkResult benchmark(F&& fn, const BenchmarkOptions& options = {}) {
+    using namespace std::chrono;
+    const auto warmup = duration<double, std::nano>(options.warmup).count();
+    const auto sampleTime =
+        duration<double, std::nano>(options.sampleTime).count();
+
+    for (const double start = detail::_BenchClock::now();
+         detail::_BenchClock::now() - start < warmup;) {
+        detail::_runBatch(fn, 1);
+    }
+
+    BenchmarkResult result;
+    result.iterations = 1;
+    while (detail::_runBatch(fn, result.iterations) < sampleTime) {
+        result.iterations *= 2;
+    }
+
+    auto& samples = result.samples;
+    samples.resize(std::max<size_t>(options.samples, 1));
+    for (auto&& sample : samples) {
+        sample = detail::_runBatch(fn, result.iterations) /
+                 static_cast<double>(result.iterations);
+    }
+    std::ranges::sort(samples);
+
+    result.min = samples.front();
+    result.median = my::median(samples.begin(), samples.end());
+    result.p99 = my::percentile(samples.begin(), samples.end(), 99);
+    result.mean = my::mean(samples.begin(), samples.end());
+    result.stddev = samples.size() > 1
+                        ? my::sdeviation(samples.begin(), samples.end())
+                        : 0.;
+    return result;
+}
+
+/**
+ * @brief Prints result of my::benchmark
+ *
+ * @param os stream to print to
+ * @param label name of measured code
+ * @param result timings
+ */
+inline void printBenchmark(std::ostream& os, std::string_view label,
+                           const BenchmarkResult& result) {
+    my::printf(os,
+               "{}\n"
+               "  {} samples of {} iterations, time per iteration:\n"
+               "    > min    : {:.2f} ns\n"
+               "    > median : {:.2f} ns\n"
+               "    > p99    : {:.2f} ns\n"
+               "    > mean   : {:.2f} ns\n"
+               "    > stddev : {:.2f} ns\n",
+               label, result.samples.size(), result.iterations, result.min,
+               result.median, result.p99, result.mean, result.stddev);
+}
+
+}  // namespace my
+
+/**
+ * @brief Micro-benchmark macro, measures expression with my::benchmark
+ * and prints min, median, p99, mean and standard deviation of time
+ * per evaluation
+ *
+ * #Example:
+ * timeit(std::sqrt(x)); // may print: [main.cpp:8] std::sqrt(x) ...
  *
  */
 #if defined(NDEBUG) && defined(MY_DONT_PRINT_TIMEIT_RESULTS)
-#define timeit(times, expr) ({ (expr); })
+#define timeit(expr) ((void)(expr))
 #else
-#define timeit(times, expr) ({                                            \
-    using namespace std::chrono;                                          \
-                                                                          \
-    auto _times = (times);                                                \
-    const auto amount = _times;                                           \
-    assert(_times >= 1);                                                  \
-                                                                          \
-    const auto start = high_resolution_clock::now();                      \
-    while (_times--) {                                                    \
-        (expr);                                                           \
-    }                                                                     \
-                                                                          \
-    const auto diff = high_resolution_clock::now() - start;               \
-    const auto ns = duration_cast<nanoseconds>(diff).count();             \
-    const auto ms = duration_cast<milliseconds>(diff).count();            \
-                                                                          \
-    my::printf(                                                           \
-        std::cerr,                                                        \
-        "[{}:{}] {}\n"                                                    \
-        "  time spent:\n"                                                 \
-        "    > total  : {} ns ({} ms)\n"                                  \
-        "    > average: {} ns ({} ms)\n",                                 \
-        __FILENAME__, __LINE__, #expr, ns, ms, ns / amount, ms / amount); \
-})
-#endif
\ No newline at end of file
+#define timeit(expr)                                                      \
+    my::printBenchmark(std::cerr,                                         \
+                       my::format("[{}:{}] {}", __FILENAME__, __LINE__,   \
+                                  #expr),                                 \
+                       my::benchmark([&]() -> decltype(auto) {            \
+                           return (expr);                                 \
+                       }))
+#endif
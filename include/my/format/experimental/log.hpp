@@ -7,29 +7,1136 @@
 #define IF_MY_LOG_COLORED(...)
 #endif
 
+// records less severe than this level are removed during compilation,
+// e.g. -DMY_LOG_MIN_LEVEL=Info removes trace and debug logging
+#ifndef MY_LOG_MIN_LEVEL
+#define MY_LOG_MIN_LEVEL Trace
+#endif
+
 #include <my/format/format.hpp>
 #include <my/format/repr.hpp>
+//
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 namespace my::experimental {
 
 #ifdef MY_LOG_COLORED
 struct LogPrintColors {
-    static my::Color ErrorColor;
-    static my::Color WarnColor;
-    static my::Color InfoColor;
+    inline static my::Color ErrorColor = my::Color::fromHex(0xff0000);
+    inline static my::Color WarnColor = my::Color::fromHex(0xffaa00);
+    inline static my::Color InfoColor = my::Color::fromHex(0x70ff80);
+    inline static my::Color DebugColor = my::Color::fromHex(0x80b0ff);
+    inline static my::Color TraceColor = my::Color::fromHex(0x9e9e9e);
 };
-my::Color LogPrintColors::ErrorColor = my::Color::fromHex(0xff0000);
-my::Color LogPrintColors::WarnColor = my::Color::fromHex(0xffaa00);
-my::Color LogPrintColors::InfoColor = my::Color::fromHex(0x70ff80);
 #endif
 
+/**
+ * @brief Severity of the record, from the least to the most severe
+ *
+ */
+enum class LogLevel : uint8_t { Trace, Debug, Info, Warn, Error, Off };
+
+/**
+ * @brief Records below this level are not compiled in,
+ * set with MY_LOG_MIN_LEVEL macro
+ *
+ */
+inline constexpr LogLevel minLogLevel = LogLevel::MY_LOG_MIN_LEVEL;
+
+/**
+ * @brief How AsyncLogger sink receives records
+ *
+ */
+enum class LogLayout {
+    Text,  // 2026-01-02T03:04:05.678901Z [Info] file.cpp:12: message key=value
+    Json   // {"time":"...","level":"info","file":"...","line":12,"msg":"..."}
+};
+
+namespace detail {
+
+inline std::atomic<LogLevel> _logLevel{LogLevel::Trace};
+
+inline constexpr std::array<std::string_view, 5> _logLevelNames{
+    "Trace", "Debug", "Info", "Warn", "Error"};
+
+inline constexpr std::array<std::string_view, 5> _logLevelKeys{
+    "trace", "debug", "info", "warn", "error"};
+
+}  // namespace detail
+
+/**
+ * @brief Sets runtime threshold of log, error, warn, info, debug and
+ * trace, records below it are skipped before anything is formatted
+ *
+ * @param level new threshold
+ * @return LogLevel previous threshold
+ */
+inline LogLevel setLogLevel(LogLevel level) {
+    return detail::_logLevel.exchange(level, std::memory_order_relaxed);
+}
+
+/**
+ * @return true if record of this level passes both compile time
+ * and runtime thresholds
+ */
+inline bool logEnabled(LogLevel level) {
+    return level >= minLogLevel and
+           level >= detail::_logLevel.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief What AsyncLogger does when ring buffer of the calling thread is
+ * full
+ *
+ */
+enum class LogOverflow {
+    Drop,      // new record is dropped
+    Block,     // caller waits until background thread makes room
+    Overwrite  // oldest record in the ring is dropped in favor of new one
+};
+
+/**
+ * @brief Counters of AsyncLogger
+ *
+ */
+struct LogStats {
+    uint64_t written = 0;      // records handed to sinks
+    uint64_t dropped = 0;      // records lost due to LogOverflow policy
+};
+
+/**
+ * @brief Opt-in for AsyncLogger to copy argument of type T into the record
+ * bitwise and format it later on background thread. By default only
+ * arithmetic, enum and string-like types are, anything else is formatted
+ * on the calling thread, since it may refer to memory (pointer, span,
+ * view, reference_wrapper) which is gone by the time record is written.
+ * @note T must be trivially copyable, default constructible and own
+ * everything it prints
+ *
+ * #Example:
+ * template <>
+ * inline constexpr bool my::experimental::enable_log_capture<Point> = true;
+ *
+ * @tparam T argument type
+ */
+template <class T>
+inline constexpr bool enable_log_capture = false;
+
+/**
+ * @brief Format string checked at compile time together with the place
+ * it is written at, so log calls capture their source location
+ *
+ * @tparam Args types of arguments
+ */
+template <class... Args>
+struct LogFormat {
+    template <size_t N>
+    consteval LogFormat(const char (&format)[N],
+                        std::source_location location =
+                            std::source_location::current())
+        : format(format), location(location) {
+    }
+
+    format_string<Args...> format;
+    std::source_location location;
+};
+
+namespace detail {
+
+/**
+ * @brief Record layout: header, then payload encoded by the writer's
+ * counterpart on producer side
+ *
+ */
+struct _LogRecordHeader {
+    void (*write)(std::string&, LogLayout, const _LogRecordHeader&,
+                  const std::byte*);
+    // frees memory payload owns, called once record is written or
+    // dropped, nullptr if payload owns nothing
+    void (*release)(const std::byte*);
+    const char* file;  // source location, line is 0 if unknown
+    uint32_t line;
+    LogLevel level;
+    int64_t time;  // nanoseconds since system_clock epoch
+};
+
+/**
+ * @brief Single producer single consumer ring of fixed size records.
+ * Producer is the owning thread, consumer is logger thread. Record words
+ * are atomics and every slot carries sequence number, so overwritten
+ * slot is detected by consumer instead of being read torn.
+ *
+ */
+class _LogRing {
+   public:
+    static constexpr size_t words = 31;
+    static constexpr size_t bytes = words * sizeof(uint64_t);
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::array<std::atomic<uint64_t>, words> data;
+    };
+
+    explicit _LogRing(size_t capacity)
+        : _slots(new Slot[capacity]), _mask(capacity - 1) {
+    }
+
+    _LogRing(const _LogRing&) = delete;
+    _LogRing& operator=(const _LogRing&) = delete;
+
+    ~_LogRing() {
+        const uint64_t head = _head.load(std::memory_order_acquire);
+        for (uint64_t i = _tail.load(std::memory_order_acquire); i != head;
+             ++i) {
+            _release(i);
+        }
+    }
+
+    size_t capacity() const noexcept { return _mask + 1; }
+
+    /**
+     * @brief Copies record into the ring
+     *
+     * @param record record bytes, at most bytes long
+     * @param size used size of record rounded up to words
+     * @param overflow policy to use if ring is full
+     * @return false if record was dropped
+     */
+    bool push(const std::array<uint64_t, words>& record, size_t size,
+              LogOverflow overflow) {
+        const uint64_t head = _head.load(std::memory_order_relaxed);
+        uint64_t tail = _tail.load(std::memory_order_acquire);
+
+        while (head - tail >= capacity()) {
+            switch (overflow) {
+                case LogOverflow::Drop:
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                case LogOverflow::Block:
+                    // wait for half of the ring, so producer and consumer
+                    // do not wake each other for every record
+                    _waiting.store(true, std::memory_order_seq_cst);
+                    tail = _tail.load(std::memory_order_seq_cst);
+                    while (head - tail > capacity() / 2) {
+                        _tail.wait(tail, std::memory_order_acquire);
+                        tail = _tail.load(std::memory_order_acquire);
+                    }
+                    _waiting.store(false, std::memory_order_relaxed);
+                    break;
+                case LogOverflow::Overwrite:
+                    if (_tail.compare_exchange_weak(
+                            tail, tail + 1, std::memory_order_acq_rel)) {
+                        // consumer lost the race, record is ours to free
+                        _release(tail);
+                        dropped.fetch_add(1, std::memory_order_relaxed);
+                        ++tail;
+                    }
+                    break;
+            }
+        }
+
+        auto& slot = _slots[head & _mask];
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < size; ++i) {
+            slot.data[i].store(record[i], std::memory_order_relaxed);
+        }
+        slot.sequence.store(head + 1, std::memory_order_release);
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Takes the oldest record out of the ring
+     *
+     * @param record receives record bytes
+     * @return false if ring is empty
+     */
+    bool pop(std::array<uint64_t, words>& record) {
+        for (;;) {
+            uint64_t tail = _tail.load(std::memory_order_acquire);
+            if (tail == _head.load(std::memory_order_acquire)) return false;
+
+            auto& slot = _slots[tail & _mask];
+            if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+                continue;  // overwritten, producer has moved the tail
+            }
+            for (size_t i = 0; i < words; ++i) {
+                record[i] = slot.data[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const bool intact =
+                slot.sequence.load(std::memory_order_relaxed) == tail + 1;
+
+            if (_tail.compare_exchange_strong(tail, tail + 1,
+                                              std::memory_order_acq_rel)) {
+                if (_waiting.load(std::memory_order_seq_cst) and
+                    _head.load(std::memory_order_relaxed) - tail <=
+                        capacity() / 2) {
+                    _tail.notify_one();
+                }
+                if (intact) return true;
+            }
+        }
+    }
+
+    bool empty() const noexcept {
+        return _tail.load(std::memory_order_acquire) ==
+               _head.load(std::memory_order_acquire);
+    }
+
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> closed{false};    // logger is gone
+    std::atomic<bool> orphaned{false};  // producer thread is gone
+
+   private:
+    // only producer writes slots, so record it has moved tail past is intact
+    void _release(uint64_t sequence) {
+        const auto& slot = _slots[sequence & _mask];
+        std::array<uint64_t, words> record;
+        for (size_t i = 0; i < words; ++i) {
+            record[i] = slot.data[i].load(std::memory_order_relaxed);
+        }
+        _LogRecordHeader header;
+        std::memcpy(&header, record.data(), sizeof(header));
+        if (header.release) {
+            header.release(reinterpret_cast<const std::byte*>(record.data()) +
+                           sizeof(header));
+        }
+    }
+
+    std::unique_ptr<Slot[]> _slots;
+    const size_t _mask;
+    alignas(64) std::atomic<uint64_t> _head{0};
+    alignas(64) std::atomic<uint64_t> _tail{0};
+    alignas(64) std::atomic<bool> _waiting{false};
+};
+
+// argument types which can be copied into the record as is,
+// strings are copied by value, anything else which may refer to memory
+// outside of itself is formatted eagerly unless opted in
+template <class T>
+concept _log_capturable =
+    std::convertible_to<const T&, std::string_view> or
+    std::is_arithmetic_v<T> or std::is_enum_v<T> or
+    (enable_log_capture<T> and std::is_trivially_copyable_v<T> and
+     std::is_default_constructible_v<T>);
+
+// format string literal, it has static storage so only pointer is stored
+struct _LogLiteral {
+    const char* data;
+    size_t size;
+};
+
+template <class T>
+using _log_captured_t =
+    std::conditional_t<std::convertible_to<const T&, std::string_view>,
+                       std::string_view, T>;
+
+// what argument, possibly named one, is decoded as
+template <class Arg>
+using _log_value_t = _log_captured_t<my::detail::_unwrap_arg_t<Arg>>;
+
+class _LogEncoder {
+   public:
+    explicit _LogEncoder(std::byte* data, size_t capacity)
+        : _data(data), _capacity(capacity) {
+    }
+
+    template <class T>
+    void put(const T& value) {
+        if constexpr (std::convertible_to<const T&, std::string_view>) {
+            const std::string_view view(value);
+            const auto size = static_cast<uint32_t>(view.size());
+            _append(&size, sizeof(size));
+            _append(view.data(), view.size());
+        } else {
+            _append(std::addressof(value), sizeof(T));
+        }
+    }
+
+    bool fits() const noexcept { return _size <= _capacity; }
+    size_t size() const noexcept { return _size; }
+
+   private:
+    void _append(const void* data, size_t size) {
+        if (_size + size <= _capacity) std::memcpy(_data + _size, data, size);
+        _size += size;
+    }
+
+    std::byte* _data;
+    size_t _capacity;
+    size_t _size = 0;
+};
+
+class _LogDecoder {
+   public:
+    explicit _LogDecoder(const std::byte* data)
+        : _data(data) {
+    }
+
+    template <class T>
+    T get() {
+        if constexpr (std::same_as<T, std::string_view>) {
+            const auto size = get<uint32_t>();
+            const std::string_view view(
+                reinterpret_cast<const char*>(_data), size);
+            _data += size;
+            return view;
+        } else {
+            T value;
+            std::memcpy(std::addressof(value), _data, sizeof(T));
+            _data += sizeof(T);
+            return value;
+        }
+    }
+
+   private:
+    const std::byte* _data;
+};
+
+// named arguments are captured as values and named again when decoded
+template <class Arg>
+struct _log_field {
+    template <class T>
+    static const T& wrap(const T& value) { return value; }
+};
+
+template <my::detail::_fixed_string Name, class T>
+struct _log_field<named_arg<Name, T>> {
+    template <class V>
+    static named_arg<Name, V> wrap(const V& value) { return {value}; }
+};
+
+inline void _appendJsonString(std::string& out, std::string_view text) {
+    constexpr std::string_view hex = "0123456789abcdef";
+    for (const char c : text) {
+        switch (c) {
+            case '"': out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out.append("\\u00");
+                    out.push_back(hex[c >> 4]);
+                    out.push_back(hex[c & 0xf]);
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+}
+
+// escapes everything appended to out since position from
+inline void _escapeJsonFrom(std::string& out, size_t from) {
+    const auto special = [](char c) {
+        return c == '"' or c == '\\' or static_cast<unsigned char>(c) < 0x20;
+    };
+    const auto first = std::find_if(out.begin() + from, out.end(), special);
+    if (first == out.end()) return;
+
+    thread_local std::string tail;
+    tail.assign(first, out.end());
+    out.erase(first, out.end());
+    _appendJsonString(out, tail);
+}
+
+// signed and unsigned char (int8_t, uint8_t) are numbers in fields,
+// while streams print them as characters
+template <class T>
+decltype(auto) _logFieldValue(const T& value) {
+    if constexpr (std::same_as<T, signed char> or
+                  std::same_as<T, unsigned char>) {
+        return static_cast<int>(value);
+    } else {
+        return (value);
+    }
+}
+
+template <class T>
+void _appendJsonValue(std::string& out, const T& value) {
+    if constexpr (std::same_as<T, bool>) {
+        out.append(value ? "true" : "false");
+    } else if constexpr (std::floating_point<T>) {
+        if (std::isfinite(value)) {
+            my::format_to(out, "{}", value);
+        } else {
+            out.append("null");
+        }
+    } else if constexpr (std::integral<T> and not std::same_as<T, char>) {
+        my::format_to(out, "{}", _logFieldValue(value));
+    } else if constexpr (std::convertible_to<const T&, std::string_view>) {
+        out.push_back('"');
+        _appendJsonString(out, value);
+        out.push_back('"');
+    } else {
+        out.push_back('"');
+        const auto from = out.size();
+        my::format_to(out, "{}", value);
+        _escapeJsonFrom(out, from);
+        out.push_back('"');
+    }
+}
+
+// checks whether format has '{name}' or '{name:spec}' anchor
+inline bool _logReferences(std::string_view format, std::string_view name) {
+    for (auto i = format.find('{'); i != format.npos;
+         i = format.find('{', i + 1)) {
+        const auto rest = format.substr(i + 1);
+        if (rest.starts_with(name) and rest.size() > name.size() and
+            (rest[name.size()] == '}' or rest[name.size()] == ':')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void _appendLogTime(std::string& out, int64_t time) {
+    using namespace std::chrono;
+    // date and time part changes once per second, it is formatted then only
+    thread_local int64_t second = -1;
+    thread_local std::string stamp;
+
+    const sys_time<nanoseconds> point{nanoseconds(time)};
+    const auto whole = floor<seconds>(point);
+    if (whole.time_since_epoch().count() != second) {
+        second = whole.time_since_epoch().count();
+        const auto day = floor<days>(whole);
+        const year_month_day date{day};
+        const hh_mm_ss clock{whole - day};
+        stamp.clear();
+        my::format_to(stamp, "{:04}-{:02}-{:02}T{:02}:{:02}:{:02}",
+                      static_cast<int>(date.year()),
+                      static_cast<unsigned>(date.month()),
+                      static_cast<unsigned>(date.day()),
+                      clock.hours().count(), clock.minutes().count(),
+                      clock.seconds().count());
+    }
+    out.append(stamp);
+    my::format_to(out, ".{:09}Z", (point - whole).count());
+}
+
+// named argument is a field, text layout skips ones message refers to
+template <class T>
+void _appendLogField(std::string& out, LogLayout layout,
+                     std::string_view format, std::string_view name,
+                     const T& value) {
+    if (name.empty()) return;
+    if (layout == LogLayout::Json) {
+        out.append(",\"");
+        out.append(name);
+        out.append("\":");
+        _appendJsonValue(out, value);
+    } else if (not _logReferences(format, name)) {
+        my::format_to(out, " {}={}", name, _logFieldValue(value));
+    }
+}
+
+/**
+ * @brief Writes one line of record, message(out) appends the message,
+ * fields(out, layout) appends key/value payload
+ *
+ */
+template <class Message, class Fields>
+void _writeRecord(std::string& out, LogLayout layout,
+                  const _LogRecordHeader& header, Message&& message,
+                  Fields&& fields) {
+    const auto level = static_cast<size_t>(header.level);
+
+    if (layout == LogLayout::Json) {
+        out.append("{\"time\":\"");
+        _appendLogTime(out, header.time);
+        out.append("\",\"level\":\"");
+        out.append(_logLevelKeys[level]);
+        out.push_back('"');
+        if (header.line) {
+            out.append(",\"file\":");
+            _appendJsonValue(out, std::string_view(header.file));
+            my::format_to(out, ",\"line\":{}", header.line);
+        }
+        out.append(",\"msg\":\"");
+        const auto from = out.size();
+        message(out);
+        _escapeJsonFrom(out, from);
+        out.push_back('"');
+        fields(out, layout);
+        out.append("}\n");
+        return;
+    }
+
+    _appendLogTime(out, header.time);
+    out.append(" [");
+    out.append(_logLevelNames[level]);
+    out.append("] ");
+    if (header.line) my::format_to(out, "{}:{}: ", header.file, header.line);
+    message(out);
+    fields(out, layout);
+    out.push_back('\n');
+}
+
+template <class... Args>
+void _writeCaptured(std::string& out, LogLayout layout,
+                    const _LogRecordHeader& header, const std::byte* data) {
+    _LogDecoder decoder(data);
+    const auto literal = decoder.get<_LogLiteral>();
+    const std::string_view format(literal.data, literal.size);
+    // braced init list keeps left to right order of decoding
+    const std::tuple<_log_value_t<Args>...> values{
+        decoder.get<_log_value_t<Args>>()...};
+
+    std::apply(
+        [&](const auto&... values) {
+            _writeRecord(
+                out, layout, header,
+                [&](std::string& out) {
+                    my::vformat_to(out, format,
+                                   my::make_format_args(
+                                       _log_field<Args>::wrap(values)...));
+                },
+                [&]([[maybe_unused]] std::string& out,
+                    [[maybe_unused]] LogLayout layout) {
+                    (_appendLogField(out, layout, format,
+                                     my::detail::_unwrap_arg<Args>::name,
+                                     values),
+                     ...);
+                });
+        },
+        values);
+}
+
+inline void _writeText(std::string& out, LogLayout layout,
+                       const _LogRecordHeader& header,
+                       const std::byte* data) {
+    _writeRecord(
+        out, layout, header,
+        [&](std::string& out) {
+            out.append(_LogDecoder(data).get<std::string_view>());
+        },
+        [](std::string&, LogLayout) {});
+}
+
+// text too long for the ring lives on heap, record owns it
+inline void _writeHeapText(std::string& out, LogLayout layout,
+                           const _LogRecordHeader& header,
+                           const std::byte* data) {
+    const auto* text = _LogDecoder(data).get<const std::string*>();
+    _writeRecord(
+        out, layout, header, [&](std::string& out) { out.append(*text); },
+        [](std::string&, LogLayout) {});
+}
+
+inline void _releaseHeapText(const std::byte* data) {
+    delete _LogDecoder(data).get<const std::string*>();
+}
+
+}  // namespace detail
+
+/**
+ * @brief Logger formatting records on background thread.
+ * Every thread logging through it gets its own lock-free ring buffer of
+ * fixed size records, so logging is a copy of arguments into that ring
+ * without locks, allocations or stream calls. Background thread drains
+ * all rings in batches, formats records and hands each batch to sinks.
+ *
+ * Record carries timestamp, level, source location of the call and its
+ * arguments. Named arguments (see my::arg) are its key/value payload:
+ * text layout appends the ones message does not refer to as key=value,
+ * json layout emits every one of them as typed field.
+ *
+ * Arguments of record are captured by value: arithmetic, enum and types
+ * opted in with enable_log_capture as is, strings by copying their
+ * characters. Records with other argument types or too long to fit
+ * recordSize are formatted on calling thread and their text is queued
+ * instead, without payload. Text longer than recordSize is moved to heap
+ * and the record carries only pointer to it, so it arrives whole.
+ *
+ * #Example:
+ * my::experimental::AsyncLogger logger({.overflow = LogOverflow::Drop});
+ * logger.addSink(std::cerr);
+ * logger.addSink(jsonFile, LogLayout::Json);
+ * logger.info("request {id} served", my::arg<"id">(id),
+ *             my::arg<"ms">(elapsed));
+ *
+ * @note records of one thread keep their order, records of different
+ * threads are not ordered between each other
+ */
+class AsyncLogger {
+   public:
+    static constexpr size_t recordSize =
+        detail::_LogRing::bytes - sizeof(detail::_LogRecordHeader);
+
+    using sink_t = std::function<void(std::string_view)>;
+
+    struct Options {
+        size_t capacity = 1024;  // records per thread, rounded up to power of 2
+        LogOverflow overflow = LogOverflow::Drop;
+        std::chrono::milliseconds interval{10};  // max delay before drain
+        LogLevel level = LogLevel::Trace;        // runtime threshold
+    };
+
+    AsyncLogger()
+        : AsyncLogger(Options{}) {
+    }
+
+    explicit AsyncLogger(Options options)
+        : _options(_normalize(options)),
+          _level(options.level),
+          _thread([this](std::stop_token stop) { _run(stop); }) {
+    }
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    /**
+     * @brief Drains all queued records and stops background thread
+     *
+     */
+    ~AsyncLogger() {
+        {
+            std::lock_guard lock(_mutex);
+            _thread.request_stop();
+        }
+        _wake.notify_one();
+        _thread.join();
+
+        std::lock_guard lock(_mutex);
+        for (auto&& ring : _rings) ring->closed.store(true);
+    }
+
+    /**
+     * @brief Adds sink receiving batches of formatted lines, sinks are
+     * called from background thread only
+     *
+     * @param sink callable with std::string_view parameter
+     * @param layout layout of lines in batch
+     */
+    void addSink(sink_t sink, LogLayout layout = LogLayout::Text) {
+        std::lock_guard lock(_mutex);
+        _sinks.push_back({std::move(sink), layout});
+        ++_generation;
+    }
+
+    /**
+     * @brief Adds stream as sink, it is flushed after each batch
+     *
+     * @param os stream which must outlive the logger
+     * @param layout layout of lines in batch
+     */
+    void addSink(std::ostream& os, LogLayout layout = LogLayout::Text) {
+        addSink(
+            [&os](std::string_view batch) {
+                os.write(batch.data(),
+                         static_cast<std::streamsize>(batch.size()));
+                os.flush();
+            },
+            layout);
+    }
+
+    /**
+     * @brief Sets runtime threshold, records below it are skipped
+     * before their arguments are copied
+     *
+     * @param level new threshold
+     */
+    void setLevel(LogLevel level) noexcept {
+        _level.store(level, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return true if record of this level would be queued
+     */
+    bool enabled(LogLevel level) const noexcept {
+        return level >= minLogLevel and
+               level >= _level.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Queues record formatted on background thread
+     *
+     * @param level severity of record
+     * @param format format string literal where '{}' is a replace anchor
+     * @param args any printable types, named ones are record payload
+     * @return false if record was skipped or dropped
+     */
+    template <my::printable<std::ostream>... Args>
+    bool log(LogLevel level, LogFormat<std::type_identity_t<Args>...> format,
+             const Args&... args) {
+        if (not enabled(level)) return false;
+        return _push(level, format, args...);
+    }
+
+    template <my::printable<std::ostream>... Args>
+    bool error(LogFormat<std::type_identity_t<Args>...> format,
+               const Args&... args) {
+        return _log<LogLevel::Error>(format, args...);
+    }
+
+    template <my::printable<std::ostream>... Args>
+    bool warn(LogFormat<std::type_identity_t<Args>...> format,
+              const Args&... args) {
+        return _log<LogLevel::Warn>(format, args...);
+    }
+
+    template <my::printable<std::ostream>... Args>
+    bool info(LogFormat<std::type_identity_t<Args>...> format,
+              const Args&... args) {
+        return _log<LogLevel::Info>(format, args...);
+    }
+
+    template <my::printable<std::ostream>... Args>
+    bool debug(LogFormat<std::type_identity_t<Args>...> format,
+               const Args&... args) {
+        return _log<LogLevel::Debug>(format, args...);
+    }
+
+    template <my::printable<std::ostream>... Args>
+    bool trace(LogFormat<std::type_identity_t<Args>...> format,
+               const Args&... args) {
+        return _log<LogLevel::Trace>(format, args...);
+    }
+
+    /**
+     * @brief Queues already formatted line, line longer than recordSize
+     * is copied to heap
+     *
+     * @param level severity of record
+     * @param text line without trailing new line
+     * @param location where record comes from, line 0 if unknown
+     * @return false if record was skipped or dropped
+     */
+    bool logFormatted(LogLevel level, std::string_view text,
+                      std::source_location location = {}) {
+        if (not enabled(level)) return false;
+
+        auto& ring = _ring();
+        record_t record;
+        if (text.size() + sizeof(uint32_t) <= recordSize) {
+            const auto words = _encode(
+                record, &detail::_writeText, nullptr, level, location,
+                [&](detail::_LogEncoder& encoder) { encoder.put(text); });
+            return _commit(ring, record, words);
+        }
+
+        auto heap = std::make_unique<const std::string>(text);
+        const auto words = _encode(
+            record, &detail::_writeHeapText, &detail::_releaseHeapText, level,
+            location,
+            [&](detail::_LogEncoder& encoder) { encoder.put(heap.get()); });
+        if (not _commit(ring, record, words)) return false;
+        heap.release();
+        return true;
+    }
+
+    /**
+     * @brief Blocks until every record queued before the call is
+     * handed to sinks
+     *
+     */
+    void flush() {
+        std::unique_lock lock(_mutex);
+        const auto ticket = ++_flushTicket;
+        _wake.notify_one();
+        _flushed.wait(lock, [&] { return _flushedTicket >= ticket; });
+    }
+
+    /**
+     * @return Counters summed over all threads
+     */
+    LogStats stats() const {
+        std::lock_guard lock(_mutex);
+        LogStats result = _retired;
+        result.written = _written.load(std::memory_order_relaxed);
+        for (auto&& ring : _rings) {
+            result.dropped += ring->dropped.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+   private:
+    using record_t = std::array<uint64_t, detail::_LogRing::words>;
+
+    struct Sink {
+        sink_t sink;
+        LogLayout layout;
+    };
+
+    template <LogLevel Level, class... Args>
+    bool _log(const LogFormat<Args...>& format, const Args&... args) {
+        if constexpr (Level < minLogLevel) {
+            return false;
+        } else {
+            if (Level < _level.load(std::memory_order_relaxed)) return false;
+            return _push(Level, format, args...);
+        }
+    }
+
+    template <class... Args>
+    bool _push(LogLevel level, const LogFormat<Args...>& format,
+               const Args&... args) {
+        auto& ring = _ring();
+
+        if constexpr ((detail::_log_capturable<
+                           my::detail::_unwrap_arg_t<Args>> and
+                       ...)) {
+            record_t record;
+            const auto words = _encode(
+                record, &detail::_writeCaptured<Args...>, nullptr, level,
+                format.location, [&](detail::_LogEncoder& encoder) {
+                    const auto view = format.format.get();
+                    encoder.put(detail::_LogLiteral{view.data(), view.size()});
+                    (encoder.put(my::detail::_unwrapArg(args)), ...);
+                });
+            if (words) return _commit(ring, record, words);
+        }
+
+        // not capturable or too long, format here and queue the text
+        thread_local std::string text;
+        text.clear();
+        my::detail::_formatTo(text, format.format,
+                              std::index_sequence_for<Args...>(), args...);
+        return logFormatted(level, text, format.location);
+    }
+
+    /**
+     * @return Number of words used by record, 0 if it does not fit
+     */
+    template <class Encode>
+    static size_t _encode(record_t& record,
+                          decltype(detail::_LogRecordHeader::write) write,
+                          decltype(detail::_LogRecordHeader::release) release,
+                          LogLevel level, std::source_location location,
+                          Encode&& encode) {
+        const auto now = std::chrono::system_clock::now().time_since_epoch();
+        const detail::_LogRecordHeader header{
+            write, release, location.file_name(),
+            static_cast<uint32_t>(location.line()), level,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()};
+        std::memcpy(record.data(), &header, sizeof(header));
+
+        auto* payload =
+            reinterpret_cast<std::byte*>(record.data()) + sizeof(header);
+        detail::_LogEncoder encoder(payload, recordSize);
+        encode(encoder);
+
+        if (not encoder.fits()) return 0;
+        return (sizeof(header) + encoder.size() + sizeof(uint64_t) - 1) /
+               sizeof(uint64_t);
+    }
+
+    bool _commit(detail::_LogRing& ring, const record_t& record,
+                 size_t words) {
+        const bool pushed = ring.push(record, words, _options.overflow);
+        // only the first record after background thread fell asleep wakes it
+        if (pushed and _sleeping.load(std::memory_order_relaxed) and
+            _sleeping.exchange(false)) {
+            { std::lock_guard lock(_mutex); }
+            _wake.notify_one();
+        }
+        return pushed;
+    }
+
+    detail::_LogRing& _ring() {
+        struct Entry {
+            uint64_t logger;
+            std::shared_ptr<detail::_LogRing> ring;
+        };
+        struct Entries : std::vector<Entry> {
+            ~Entries() {
+                for (auto&& entry : *this) entry.ring->orphaned.store(true);
+            }
+        };
+        thread_local Entries entries;
+
+        for (auto&& entry : entries) {
+            if (entry.logger == _id) return *entry.ring;
+        }
+
+        std::erase_if(entries, [](const Entry& entry) {
+            return entry.ring->closed.load();
+        });
+
+        auto ring = std::make_shared<detail::_LogRing>(_options.capacity);
+        {
+            std::lock_guard lock(_mutex);
+            _rings.push_back(ring);
+            ++_generation;
+        }
+        entries.push_back({_id, ring});
+        return *ring;
+    }
+
+    void _run(std::stop_token stop) {
+        // one batch per layout, filled only if some sink uses it
+        std::array<std::string, 2> batches;
+        std::array<bool, 2> used{};
+        record_t record;
+        std::vector<std::shared_ptr<detail::_LogRing>> rings;
+        std::vector<Sink> sinks;
+        uint64_t generation = 0;
+
+        for (;;) {
+            uint64_t ticket;
+            {
+                std::lock_guard lock(_mutex);
+                ticket = _flushTicket;
+                if (generation != _generation) {
+                    generation = _generation;
+                    rings = _rings;
+                    sinks = _sinks;
+                    used.fill(false);
+                    for (auto&& sink : sinks) {
+                        used[static_cast<size_t>(sink.layout)] = true;
+                    }
+                }
+            }
+
+            size_t count = 0;
+            for (auto&& batch : batches) batch.clear();
+            for (auto&& ring : rings) {
+                while (ring->pop(record)) {
+                    detail::_LogRecordHeader header;
+                    std::memcpy(&header, record.data(), sizeof(header));
+                    const auto* payload =
+                        reinterpret_cast<const std::byte*>(record.data()) +
+                        sizeof(header);
+                    for (size_t layout = 0; layout < used.size(); ++layout) {
+                        if (not used[layout]) continue;
+                        header.write(batches[layout],
+                                     static_cast<LogLayout>(layout), header,
+                                     payload);
+                    }
+                    if (header.release) header.release(payload);
+                    ++count;
+                }
+            }
+
+            if (count) {
+                for (auto&& sink : sinks) {
+                    sink.sink(batches[static_cast<size_t>(sink.layout)]);
+                }
+                _written.fetch_add(count, std::memory_order_relaxed);
+            }
+
+            std::unique_lock lock(_mutex);
+            _retire();
+            if (_flushedTicket < ticket) {
+                _flushedTicket = ticket;
+                _flushed.notify_all();
+            }
+
+            if (count) continue;
+            if (stop.stop_requested()) return;
+
+            _sleeping.store(true);
+            _wake.wait_for(lock, _options.interval, [&] {
+                return stop.stop_requested() or _flushTicket != ticket or
+                       not _sleeping.load();
+            });
+            _sleeping.store(false);
+        }
+    }
+
+    // rings of exited threads are freed once drained
+    void _retire() {
+        const auto retired = std::erase_if(_rings, [&](const auto& ring) {
+            if (not ring->orphaned.load() or not ring->empty()) return false;
+            _retired.dropped += ring->dropped.load();
+            return true;
+        });
+        if (retired) ++_generation;
+    }
+
+    static Options _normalize(Options options) {
+        options.capacity = std::bit_ceil(std::max<size_t>(options.capacity, 2));
+        return options;
+    }
+
+    inline static std::atomic<uint64_t> _ids{0};
+
+    const uint64_t _id = ++_ids;
+    Options _options;
+    std::atomic<LogLevel> _level;
+    mutable std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _flushed;
+    std::vector<std::shared_ptr<detail::_LogRing>> _rings;
+    std::vector<Sink> _sinks;
+    LogStats _retired;
+    uint64_t _generation = 0;
+    uint64_t _flushTicket = 0;
+    uint64_t _flushedTicket = 0;
+    std::atomic<uint64_t> _written{0};
+    std::atomic<bool> _sleeping{false};
+    std::jthread _thread;
+};
+
+namespace detail {
+
+inline std::atomic<AsyncLogger*> _asyncLogger{nullptr};
+
+}  // namespace detail
+
+/**
+ * @brief Switches error, warn, info, debug and trace to async mode:
+ * lines are formatted on the calling thread and queued to logger instead
+ * of being written to the stream.
+ * @note log() has no level, so it is never filtered and always writes to
+ * std::cout directly, whether logger is set or not
+ *
+ * @param logger logger to use or nullptr to log synchronously again
+ * @return AsyncLogger* previously set logger
+ */
+inline AsyncLogger* setAsyncLogger(AsyncLogger* logger) {
+    return detail::_asyncLogger.exchange(logger);
+}
+
 template <class Ch, class Tr,
           my::representable<std::basic_ostream<Ch, Tr>>... Args>
 auto log(std::basic_ostream<Ch, Tr>& os, const Ch* format, Args&&... args) {
-    my::pretty.printf(os, format, std::forward<Args>(args)...);
+    // runtime format prints literal text even when there are no arguments
+    my::vprintf(os, format,
+                my::make_format_args<Ch, Tr>(my::pretty.view(args)...));
     os << os.widen('\n');
 }
 
+namespace detail {
+
+template <class... Args>
+bool _logAsync(LogLevel level, const char* format, Args&&... args) {
+    auto* logger = _asyncLogger.load(std::memory_order_acquire);
+    if (not logger) return false;
+
+    thread_local std::string text;
+    text.clear();
+    my::vformat_to(text, format,
+                   my::make_format_args(my::pretty.view(args)...));
+    logger->logFormatted(level, text);
+    return true;
+}
+
+}  // namespace detail
+
 template <class Ch,
           my::representable<std::basic_ostream<Ch>>... Args>
 auto log(const Ch* format, Args&&... args) {
@@ -43,28 +1150,76 @@ auto log(const Ch* format, Args&&... args) {
 template <class Ch,
           my::representable<std::basic_ostream<Ch>>... Args>
 auto error(const Ch* format, Args&&... args) {
-    IF_MY_LOG_COLORED(std::cerr << my::fg(LogPrintColors::ErrorColor));
-    my::printf(std::cerr, "[Error]: ");
-    my::log(std::cerr, format, std::forward<Args>(args)...);
-    IF_MY_LOG_COLORED(std::cerr << my::resetcol);
+    if constexpr (LogLevel::Error >= minLogLevel) {
+        if (not logEnabled(LogLevel::Error)) return;
+        if constexpr (std::same_as<Ch, char>) {
+            if (detail::_logAsync(LogLevel::Error, format, args...)) return;
+        }
+        IF_MY_LOG_COLORED(std::cerr << my::fg(LogPrintColors::ErrorColor));
+        my::printf(std::cerr, "[Error]: ");
+        log(std::cerr, format, std::forward<Args>(args)...);
+        IF_MY_LOG_COLORED(std::cerr << my::resetcol);
+    }
 }
 
 template <class Ch,
           my::representable<std::basic_ostream<Ch>>... Args>
 auto warn(const Ch* format, Args&&... args) {
-    IF_MY_LOG_COLORED(std::cerr << my::fg(LogPrintColors::WarnColor));
-    my::printf(std::cerr, "[Warn]: ");
-    my::log(std::cerr, format, std::forward<Args>(args)...);
-    IF_MY_LOG_COLORED(std::cerr << my::resetcol);
+    if constexpr (LogLevel::Warn >= minLogLevel) {
+        if (not logEnabled(LogLevel::Warn)) return;
+        if constexpr (std::same_as<Ch, char>) {
+            if (detail::_logAsync(LogLevel::Warn, format, args...)) return;
+        }
+        IF_MY_LOG_COLORED(std::cerr << my::fg(LogPrintColors::WarnColor));
+        my::printf(std::cerr, "[Warn]: ");
+        log(std::cerr, format, std::forward<Args>(args)...);
+        IF_MY_LOG_COLORED(std::cerr << my::resetcol);
+    }
 }
 
 template <class Ch,
           my::representable<std::basic_ostream<Ch>>... Args>
 auto info(const Ch* format, Args&&... args) {
-    IF_MY_LOG_COLORED(std::cerr << my::fg(LogPrintColors::InfoColor));
-    my::printf(std::cerr, "[Info]: ");
-    my::log(std::cerr, format, std::forward<Args>(args)...);
-    IF_MY_LOG_COLORED(std::cerr << my::resetcol);
+    if constexpr (LogLevel::Info >= minLogLevel) {
+        if (not logEnabled(LogLevel::Info)) return;
+        if constexpr (std::same_as<Ch, char>) {
+            if (detail::_logAsync(LogLevel::Info, format, args...)) return;
+        }
+        IF_MY_LOG_COLORED(std::cerr << my::fg(LogPrintColors::InfoColor));
+        my::printf(std::cerr, "[Info]: ");
+        log(std::cerr, format, std::forward<Args>(args)...);
+        IF_MY_LOG_COLORED(std::cerr << my::resetcol);
+    }
+}
+
+template <class Ch,
+          my::representable<std::basic_ostream<Ch>>... Args>
+auto debug(const Ch* format, Args&&... args) {
+    if constexpr (LogLevel::Debug >= minLogLevel) {
+        if (not logEnabled(LogLevel::Debug)) return;
+        if constexpr (std::same_as<Ch, char>) {
+            if (detail::_logAsync(LogLevel::Debug, format, args...)) return;
+        }
+        IF_MY_LOG_COLORED(std::cerr << my::fg(LogPrintColors::DebugColor));
+        my::printf(std::cerr, "[Debug]: ");
+        log(std::cerr, format, std::forward<Args>(args)...);
+        IF_MY_LOG_COLORED(std::cerr << my::resetcol);
+    }
+}
+
+template <class Ch,
+          my::representable<std::basic_ostream<Ch>>... Args>
+auto trace(const Ch* format, Args&&... args) {
+    if constexpr (LogLevel::Trace >= minLogLevel) {
+        if (not logEnabled(LogLevel::Trace)) return;
+        if constexpr (std::same_as<Ch, char>) {
+            if (detail::_logAsync(LogLevel::Trace, format, args...)) return;
+        }
+        IF_MY_LOG_COLORED(std::cerr << my::fg(LogPrintColors::TraceColor));
+        my::printf(std::cerr, "[Trace]: ");
+        log(std::cerr, format, std::forward<Args>(args)...);
+        IF_MY_LOG_COLORED(std::cerr << my::resetcol);
+    }
 }
 
-}  // namespace my
\ No newline at end of file
+}  // namespace my::experimental
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <my/format/format.hpp>
 #include <my/format/symbols.hpp>
 #include <my/util/concepts.hpp>
 #include <my/util/math.hpp>
@@ -9,10 +10,8 @@
 #include <cassert>
 #include <cmath>
 #include <cstdio>
-#include <iomanip>
 #include <iostream>
 #include <map>
-#include <sstream>
 #include <string>
 #include <vector>
 
@@ -144,13 +143,12 @@ auto plot(std::ostream& os, Iter b, Iter e, const PlotDimension& d = {}, char ma
     std::vector<std::string> graph;
     graph.reserve(d.height);
     for (size_t i = 0; i < d.height; i++) {
-        std::stringstream ss;
-        ss << std::fixed << std::setprecision(2)
-           << std::right << std::setw(o.maxLen)
-           << my::map<float>(i, 0, d.height - 1, o.max.y, o.min.y)
-           << "  " << styles[curvy][7];
+        auto row = my::format(
+            "{:.2f}", my::map<float>(i, 0, d.height - 1, o.max.y, o.min.y));
+        if (row.size() < o.maxLen) row.insert(0, o.maxLen - row.size(), ' ');
+        my::format_to(row, "  {}", styles[curvy][7]);
 
-        graph.push_back(ss.str());
+        graph.push_back(std::move(row));
         graph[i].resize(d.width + o.maxLen, ' ');
     }
 
@@ -170,16 +168,13 @@ auto plot(std::ostream& os, Iter b, Iter e, const PlotDimension& d = {}, char ma
 
     size_t longestLabel = 0;
     for (size_t i = 0; i < d.width; i++) {
-        std::stringstream ss;
-        ss << std::fixed << std::setprecision(2)
-           << my::map<float>(i, 0, d.width - 1, o.min.x, o.max.x);
-
-        const auto label = ss.str();
-
-        xLabels.push_back(label);
+        auto label = my::format(
+            "{:.2f}", my::map<float>(i, 0, d.width - 1, o.min.x, o.max.x));
 
         if (longestLabel < label.size())
             longestLabel = label.size();
+
+        xLabels.push_back(std::move(label));
     }
 
     const auto yPad = std::string(o.maxLen + 3, ' ');
@@ -197,7 +192,8 @@ auto plot(std::ostream& os, Iter b, Iter e, const PlotDimension& d = {}, char ma
     // values
     my::printf(os, "\n{}", yPad);
     for (size_t i = 0; i < xLabels.size(); i += longestLabel + 1) {
-        os << std::left << std::setw(longestLabel + 1) << xLabels[i];
+        xLabels[i].resize(longestLabel + 1, ' ');
+        os << xLabels[i];
     }
 
     my::printf("\n");
@@ -0,0 +1,559 @@
+#pragma once
+#ifndef MY_FILE_SINKS_HPP
+#define MY_FILE_SINKS_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <concepts>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <my/util/win_defs.hpp>
+#define MY_FILE_SINKS_WIN32 1
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace my {
+
+/**
+ * @brief Destination of already formatted text, which can be written from
+ * any thread. Satisfied by my::RotatingFileSink and my::MappedFileSink,
+ * callable with std::string_view as well, so sinks can be handed to
+ * my::experimental::AsyncLogger::addSink by std::ref.
+ *
+ */
+template <class T>
+concept output_sink = requires(T& sink, std::string_view text) {
+    { sink.write(text) } -> std::same_as<bool>;
+    sink.flush();
+};
+
+/**
+ * @brief File sink starting new file once current one grows over size
+ * limit or gets older than time limit. Rotated files are renamed
+ * "name.1.ext", "name.2.ext" and so on, larger number is older file, the
+ * ones over the file limit are removed.
+ * Output is buffered by C stdio with large buffer and written as is,
+ * without stream sentries, locale or virtual calls per write.
+ *
+ * #Example:
+ * my::RotatingFileSink sink("app.log", {.maxSize = 64 << 20, .maxFiles = 8});
+ * my::sink_ostream os(sink);
+ * my::printf(os, "{} requests served\n", count);
+ *
+ * @note writes are serialized with mutex, record is never split
+ * between two files
+ */
+class RotatingFileSink {
+   public:
+    struct Options {
+        size_t maxSize = 0;  // bytes per file, 0 is no limit
+        std::chrono::seconds maxAge{0};  // age of file, 0 is no limit
+        size_t maxFiles = 5;   // rotated files kept besides current one
+        size_t bufferSize = 1 << 16;
+    };
+
+    /**
+     * @brief Opens file for appending
+     * @note throws std::system_error if file can not be opened
+     *
+     * @param path path to current file
+     * @param options limits of single file
+     */
+    explicit RotatingFileSink(std::filesystem::path path)
+        : RotatingFileSink(std::move(path), Options{}) {
+    }
+
+    RotatingFileSink(std::filesystem::path path, Options options)
+        : _path(std::move(path)), _options(options) {
+        if (not _open()) {
+            throw std::system_error(errno, std::generic_category(),
+                                    "RotatingFileSink: " + _path.string());
+        }
+    }
+
+    RotatingFileSink(const RotatingFileSink&) = delete;
+    RotatingFileSink& operator=(const RotatingFileSink&) = delete;
+
+    ~RotatingFileSink() { _close(); }
+
+    /**
+     * @brief Appends text to current file, rotating it first if the text
+     * would not fit size limit or file is too old
+     *
+     * @param text text to write
+     * @return false if write failed
+     */
+    bool write(std::string_view text) {
+        std::lock_guard lock(_mutex);
+        if (_expired(text.size())) _rotate();
+        if (not _file) return false;
+
+        _size += text.size();
+        return std::fwrite(text.data(), 1, text.size(), _file) == text.size();
+    }
+
+    void flush() {
+        std::lock_guard lock(_mutex);
+        if (_file) std::fflush(_file);
+    }
+
+    /**
+     * @brief Starts new file regardless of limits
+     *
+     */
+    void rotate() {
+        std::lock_guard lock(_mutex);
+        _rotate();
+    }
+
+    void operator()(std::string_view text) { write(text); }
+
+    const std::filesystem::path& path() const noexcept { return _path; }
+
+    /**
+     * @return Path of i-th rotated file, 0 is current one
+     */
+    std::filesystem::path path(size_t i) const {
+        if (i == 0) return _path;
+        auto result = _path.parent_path() / _path.stem();
+        result += "." + std::to_string(i);
+        result += _path.extension();
+        return result;
+    }
+
+   private:
+    bool _expired(size_t incoming) const {
+        if (_options.maxSize and _size and
+            _size + incoming > _options.maxSize) {
+            return true;
+        }
+        return _options.maxAge.count() and
+               std::chrono::steady_clock::now() - _opened >= _options.maxAge;
+    }
+
+    // failure to reopen on rotation is reported by write() returning false
+    bool _open() {
+        _file = std::fopen(_path.string().c_str(), "ab");
+        if (not _file) return false;
+
+        _buffer.resize(_options.bufferSize);
+        if (not _buffer.empty()) {
+            std::setvbuf(_file, _buffer.data(), _IOFBF, _buffer.size());
+        }
+
+        std::error_code error;
+        const auto size = std::filesystem::file_size(_path, error);
+        _size = error ? 0 : static_cast<size_t>(size);
+        _opened = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void _close() noexcept {
+        if (_file) std::fclose(_file);
+        _file = nullptr;
+    }
+
+    void _rotate() {
+        _close();
+
+        std::error_code error;
+        if (_options.maxFiles == 0) {
+            std::filesystem::remove(_path, error);
+        } else {
+            std::filesystem::remove(path(_options.maxFiles), error);
+            for (size_t i = _options.maxFiles; i > 0; --i) {
+                std::filesystem::rename(path(i - 1), path(i), error);
+            }
+        }
+
+        _open();
+    }
+
+    std::filesystem::path _path;
+    Options _options;
+    std::mutex _mutex;
+    std::FILE* _file = nullptr;
+    std::vector<char> _buffer;
+    size_t _size = 0;
+    std::chrono::steady_clock::time_point _opened;
+};
+
+/**
+ * @brief Append only file sink writing through shared memory mapping.
+ * File is extended and mapped by windows of fixed size ahead of writers,
+ * each write reserves its range with single atomic add to file offset and
+ * copies text there, so concurrent writers do not lock each other and
+ * there are no system calls per write. New window is mapped under the
+ * lock once writers reach it.
+ *
+ * #Example:
+ * my::MappedFileSink sink("trace.log");
+ * logger.addSink(std::ref(sink));
+ *
+ * @note file is cut to written size on destruction, after a crash it
+ * keeps zero filled tail of the last window. Once file can not be
+ * extended or mapped, failed record and all the following ones are
+ * rejected, and file is cut right before that record, so it never has
+ * zero filled holes in the middle.
+ */
+class MappedFileSink {
+   public:
+    static constexpr size_t maxWindows = 4096;
+
+    /**
+     * @brief Creates or truncates file and maps first window of it
+     * @note throws std::system_error if file can not be created or mapped
+     *
+     * @param path path to file
+     * @param window size of mapped window, rounded up to 1 MiB
+     */
+    explicit MappedFileSink(const std::filesystem::path& path,
+                            size_t window = size_t(64) << 20)
+        : _window(std::max<size_t>((window + _granularity - 1) /
+                                       _granularity * _granularity,
+                                   _granularity)) {
+        _open(path);
+    }
+
+    MappedFileSink(const MappedFileSink&) = delete;
+    MappedFileSink& operator=(const MappedFileSink&) = delete;
+
+    ~MappedFileSink() { _close(); }
+
+    /**
+     * @brief Appends text to the file
+     *
+     * @param text text to write
+     * @return false if file could not be extended to fit it or earlier
+     * write failed
+     */
+    bool write(std::string_view text) {
+        const size_t start = _offset.fetch_add(text.size(),
+                                               std::memory_order_relaxed);
+        if (start >= _failedAt.load(std::memory_order_relaxed)) return false;
+
+        size_t offset = start;
+        while (not text.empty()) {
+            const size_t index = offset / _window;
+            const size_t at = offset % _window;
+            char* window = _windowAt(index);
+            if (not window) {
+                _fail(start);
+                return false;
+            }
+
+            const size_t chunk = std::min(text.size(), _window - at);
+            std::memcpy(window + at, text.data(), chunk);
+            text.remove_prefix(chunk);
+            offset += chunk;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Asks OS to write mapped pages back to the file,
+     * written text is visible to readers of the file without it
+     *
+     */
+    void flush() {
+        std::lock_guard lock(_mutex);
+        for (size_t i = 0; i < maxWindows; ++i) {
+            char* window = _windows[i].load(std::memory_order_acquire);
+            if (not window) break;
+#if defined(MY_FILE_SINKS_WIN32)
+            FlushViewOfFile(window, _window);
+#else
+            ::msync(window, _window, MS_ASYNC);
+#endif
+        }
+    }
+
+    void operator()(std::string_view text) { write(text); }
+
+    /**
+     * @return Number of bytes written so far
+     */
+    size_t size() const noexcept {
+        return std::min(_offset.load(std::memory_order_relaxed),
+                        _failedAt.load(std::memory_order_relaxed));
+    }
+
+   private:
+    static constexpr size_t _granularity = size_t(1) << 20;
+
+    // remembers the earliest failed record, file ends right before it
+    void _fail(size_t offset) noexcept {
+        size_t failed = _failedAt.load(std::memory_order_relaxed);
+        while (offset < failed and
+               not _failedAt.compare_exchange_weak(
+                   failed, offset, std::memory_order_relaxed)) {
+        }
+    }
+
+    char* _windowAt(size_t index) {
+        if (index >= maxWindows) return nullptr;
+        if (char* window = _windows[index].load(std::memory_order_acquire)) {
+            return window;
+        }
+        std::lock_guard lock(_mutex);
+        for (size_t i = 0; i <= index; ++i) {
+            if (not _windows[i].load(std::memory_order_relaxed) and
+                not _map(i)) {
+                return nullptr;
+            }
+        }
+        return _windows[index].load(std::memory_order_relaxed);
+    }
+
+#if defined(MY_FILE_SINKS_WIN32)
+    void _open(const std::filesystem::path& path) {
+        _file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                            FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (_file == INVALID_HANDLE_VALUE or not _map(0)) {
+            const auto error = static_cast<int>(GetLastError());
+            if (_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+            throw std::system_error(error, std::system_category(),
+                                    "MappedFileSink");
+        }
+    }
+
+    bool _map(size_t index) {
+        const uint64_t end = (index + 1) * uint64_t(_window);
+        HANDLE mapping = CreateFileMappingW(
+            _file, nullptr, PAGE_READWRITE, static_cast<DWORD>(end >> 32),
+            static_cast<DWORD>(end), nullptr);
+        if (not mapping) return false;
+
+        const uint64_t begin = index * uint64_t(_window);
+        void* data = MapViewOfFile(mapping, FILE_MAP_WRITE,
+                                   static_cast<DWORD>(begin >> 32),
+                                   static_cast<DWORD>(begin), _window);
+        CloseHandle(mapping);
+        if (not data) return false;
+
+        _windows[index].store(static_cast<char*>(data),
+                              std::memory_order_release);
+        return true;
+    }
+
+    void _close() noexcept {
+        for (auto&& window : _windows) {
+            if (char* data = window.load()) UnmapViewOfFile(data);
+        }
+        LARGE_INTEGER size;
+        size.QuadPart = static_cast<LONGLONG>(this->size());
+        SetFilePointerEx(_file, size, nullptr, FILE_BEGIN);
+        SetEndOfFile(_file);
+        CloseHandle(_file);
+    }
+
+    HANDLE _file = INVALID_HANDLE_VALUE;
+#else
+    void _open(const std::filesystem::path& path) {
+        _fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                     0644);
+        if (_fd == -1 or not _map(0)) {
+            const int error = errno;
+            if (_fd != -1) ::close(_fd);
+            throw std::system_error(error, std::generic_category(),
+                                    "MappedFileSink");
+        }
+    }
+
+    bool _map(size_t index) {
+        const auto end = static_cast<off_t>((index + 1) * _window);
+        if (::ftruncate(_fd, end) == -1) return false;
+
+        void* data = ::mmap(nullptr, _window, PROT_READ | PROT_WRITE,
+                            MAP_SHARED, _fd,
+                            static_cast<off_t>(index * _window));
+        if (data == MAP_FAILED) return false;
+
+        _windows[index].store(static_cast<char*>(data),
+                              std::memory_order_release);
+        return true;
+    }
+
+    void _close() noexcept {
+        for (auto&& window : _windows) {
+            if (char* data = window.load()) ::munmap(data, _window);
+        }
+        [[maybe_unused]] const auto result =
+            ::ftruncate(_fd, static_cast<off_t>(size()));
+        ::close(_fd);
+    }
+
+    int _fd = -1;
+#endif
+
+    const size_t _window;
+    alignas(64) std::atomic<size_t> _offset{0};
+    std::atomic<size_t> _failedAt{SIZE_MAX};
+    std::mutex _mutex;
+    std::array<std::atomic<char*>, maxWindows> _windows{};
+};
+
+namespace detail {
+
+/**
+ * @brief Stream buffer collecting output and handing it to the sink in
+ * chunks, so sink is called once per buffer instead of once per operator<<.
+ * Only complete lines are handed over when buffer is full, unfinished one
+ * is kept for the next chunk, buffer grows to fit line longer than it.
+ *
+ */
+class _SinkBuf : public std::streambuf {
+   public:
+    template <output_sink Sink>
+    explicit _SinkBuf(Sink& sink, size_t size)
+        : _sink(&sink),
+          _write([](void* sink, std::string_view text) {
+              return static_cast<Sink*>(sink)->write(text);
+          }),
+          _flush([](void* sink) { static_cast<Sink*>(sink)->flush(); }),
+          _buffer(std::max<size_t>(size, 1)) {
+        setp(_buffer.data(), _buffer.data() + _buffer.size());
+    }
+
+   protected:
+    int_type overflow(int_type ch) override {
+        if (traits_type::eq_int_type(ch, traits_type::eof())) {
+            return _drain() ? traits_type::not_eof(ch) : traits_type::eof();
+        }
+        if (not _makeRoom()) return traits_type::eof();
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+        return ch;
+    }
+
+    std::streamsize xsputn(const char* data, std::streamsize size) override {
+        std::streamsize written = 0;
+
+        // complete lines of large text go to the sink directly when
+        // there is nothing buffered in front of them
+        if (pptr() == pbase() and
+            size >= static_cast<std::streamsize>(_buffer.size())) {
+            const auto last =
+                std::string_view(data, static_cast<size_t>(size)).rfind('\n');
+            if (last != std::string_view::npos) {
+                if (not _write(_sink, {data, last + 1})) return 0;
+                written = static_cast<std::streamsize>(last + 1);
+            }
+        }
+
+        while (written < size) {
+            if (pptr() == epptr() and not _makeRoom()) break;
+            const auto chunk = std::min<std::streamsize>(
+                {size - written, epptr() - pptr(), INT_MAX});
+            traits_type::copy(pptr(), data + written,
+                              static_cast<size_t>(chunk));
+            pbump(static_cast<int>(chunk));
+            written += chunk;
+        }
+        return written;
+    }
+
+    int sync() override {
+        const bool ok = _drain();
+        _flush(_sink);
+        return ok ? 0 : -1;
+    }
+
+   private:
+    // hands everything buffered to the sink, unfinished line included
+    bool _drain() {
+        const auto size = static_cast<size_t>(pptr() - pbase());
+        _setUsed(0);
+        return size == 0 or _write(_sink, {_buffer.data(), size});
+    }
+
+    // hands complete lines to the sink and moves unfinished one to the
+    // front, so concurrent streams sharing sink never tear each other's
+    // lines, buffer holding part of single line is grown instead
+    bool _makeRoom() {
+        const auto size = static_cast<size_t>(pptr() - pbase());
+        const auto last = std::string_view(_buffer.data(), size).rfind('\n');
+
+        if (last == std::string_view::npos) {
+            _buffer.resize(_buffer.size() * 2);
+            _setUsed(size);
+            return true;
+        }
+
+        const bool ok = _write(_sink, {_buffer.data(), last + 1});
+        std::copy(_buffer.data() + last + 1, _buffer.data() + size,
+                  _buffer.data());
+        _setUsed(size - last - 1);
+        return ok;
+    }
+
+    void _setUsed(size_t used) {
+        setp(_buffer.data(), _buffer.data() + _buffer.size());
+        for (; used > INT_MAX; used -= INT_MAX) pbump(INT_MAX);
+        pbump(static_cast<int>(used));
+    }
+
+    void* _sink;
+    bool (*_write)(void*, std::string_view);
+    void (*_flush)(void*);
+    std::vector<char> _buffer;
+};
+
+}  // namespace detail
+
+/**
+ * @brief Output stream over any my::output_sink, so my::printf,
+ * my::experimental::log and printers can write into file sinks.
+ * Each stream has its own buffer, sink receives only complete lines
+ * unless stream is flushed in the middle of one, thus one stream per
+ * thread may share the same sink without tearing each other's lines.
+ *
+ * #Example:
+ * my::MappedFileSink sink("out.txt");
+ * my::sink_ostream os(sink);
+ * os << "Hello World!\n";
+ *
+ * @note sink must outlive the stream, stream is flushed on destruction
+ */
+class sink_ostream : public std::ostream {
+   public:
+    static constexpr size_t defaultBufferSize = 8192;
+
+    template <output_sink Sink>
+    explicit sink_ostream(Sink& sink, size_t bufferSize = defaultBufferSize)
+        : std::ostream(nullptr), _buffer(sink, bufferSize) {
+        init(&_buffer);
+    }
+
+    sink_ostream(const sink_ostream&) = delete;
+    sink_ostream& operator=(const sink_ostream&) = delete;
+
+    ~sink_ostream() { _buffer.pubsync(); }
+
+   private:
+    detail::_SinkBuf _buffer;
+};
+
+}  // namespace my
+
+#endif  // MY_FILE_SINKS_HPP
@@ -2,72 +2,1393 @@
 
 #include <my/util/concepts.hpp>
 //
+#include <algorithm>
 #include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <concepts>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <map>
+#include <span>
 #include <sstream>
+#include <stdexcept>
+#include <streambuf>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace my {
 
+/**
+ * @brief Parsed replace anchor specification, the part after ':' in
+ * '{:[[fill]align][sign][#][0][width][.precision][type]}'
+ *
+ * fill      any single code unit except '{' and '}', ' ' by default
+ * align     '<' left, '>' right, '^' center; numbers are aligned right
+ *           and everything else left by default
+ * sign      '+' always, '-' only negative (default), ' ' space for positive
+ * #         base prefix (0b, 0, 0x) for integers, decimal point for floats
+ * 0         pad numbers with zeros after sign and prefix
+ * width     minimal width in code units
+ * precision digits after point for floats, max length for strings
+ * type      integers: b B c d o x X, floats: a A e E f F g G, strings: s
+ */
+struct format_spec {
+    char32_t fill = ' ';
+    char align = '\0';
+    char sign = '\0';
+    bool alternate = false;
+    bool zero = false;
+    size_t width = 0;
+    int precision = -1;
+    char type = '\0';
+
+    /**
+     * @return true if spec is the same as in plain '{}' anchor
+     */
+    constexpr bool empty() const noexcept {
+        return align == '\0' and sign == '\0' and not alternate and
+               not zero and width == 0 and precision < 0 and type == '\0';
+    }
+};
+
 namespace detail {
 
+// not constexpr on purpose: reaching it during constant evaluation
+// fails compilation with the message shown in the diagnostic
+[[noreturn]] inline void _formatError(const char* what) {
+    throw std::invalid_argument(what);
+}
+
+template <class Ch, class Tr, class Error>
+constexpr size_t _parseSpecNumber(std::basic_string_view<Ch, Tr> spec,
+                                  size_t& i, Error&& error) {
+    size_t result = 0;
+    for (; i < spec.size() and not Tr::lt(spec[i], Ch('0')) and
+           not Tr::lt(Ch('9'), spec[i]);
+         ++i) {
+        result = result * 10 + static_cast<size_t>(spec[i] - Ch('0'));
+        if (result > std::numeric_limits<int>::max()) {
+            error("Format spec width or precision is too large");
+            return 0;
+        }
+    }
+    return result;
+}
+
 template <class Ch, class Tr>
-[[maybe_unused]] constexpr void
-_printf(std::basic_ostream<Ch, Tr>& os, const Ch* fmt) { os << fmt; }
+constexpr size_t _parseSpecNumber(std::basic_string_view<Ch, Tr> spec,
+                                  size_t& i) {
+    return _parseSpecNumber(spec, i,
+                            [](const char* what) { _formatError(what); });
+}
 
-template <class Ch, class Tr,
-          my::printable<std::basic_ostream<Ch, Tr>> Arg,
-          my::printable<std::basic_ostream<Ch, Tr>>... Args>
-constexpr void _printf(std::basic_ostream<Ch, Tr>& os,
-                       const Ch* fmt, Arg&& arg, Args&&... args) {
-    for (; !Tr::eq(*fmt, '\0'); ++fmt) {
-        if (Tr::eq(*fmt, '{') and Tr::eq(*(fmt + 1), '}')) {
-            return _printf(os << arg, (fmt + 2), std::forward<Args>(args)...);
+/**
+ * @brief Parses spec of replace anchor, text between ':' and '}'
+ *
+ * @param spec spec text
+ * @param error called with reason if spec is invalid, parsing stops then
+ * and result is unspecified
+ * @return format_spec parsed spec
+ */
+template <class Ch, class Tr, class Error>
+constexpr format_spec _parseSpec(std::basic_string_view<Ch, Tr> spec,
+                                 Error&& error) {
+    constexpr std::string_view aligns = "<>^";
+    constexpr std::string_view signs = "+- ";
+    constexpr std::string_view types = "aAbBcdeEfFgGosxX";
+
+    auto isOneOf = [](std::string_view set, Ch ch) {
+        return static_cast<std::make_unsigned_t<Ch>>(ch) < 0x80 and
+               set.find(static_cast<char>(ch)) != set.npos;
+    };
+
+    format_spec result;
+    size_t i = 0;
+
+    if (spec.size() > 1 and isOneOf(aligns, spec[1])) {
+        if (Tr::eq(spec[0], '{') or Tr::eq(spec[0], '}')) {
+            error("Format spec fill can not be '{' or '}'");
+            return result;
+        }
+        if constexpr (std::same_as<Ch, char>) {
+            if (static_cast<unsigned char>(spec[0]) >= 0x80) {
+                error("Format spec fill must be single code unit");
+                return result;
+            }
+        }
+        result.fill = static_cast<char32_t>(
+            static_cast<std::make_unsigned_t<Ch>>(spec[0]));
+        result.align = static_cast<char>(spec[1]);
+        i = 2;
+    } else if (not spec.empty() and isOneOf(aligns, spec[0])) {
+        result.align = static_cast<char>(spec[0]);
+        i = 1;
+    }
+
+    if (i < spec.size() and isOneOf(signs, spec[i])) {
+        result.sign = static_cast<char>(spec[i++]);
+    }
+    if (i < spec.size() and Tr::eq(spec[i], '#')) {
+        result.alternate = true, ++i;
+    }
+    if (i < spec.size() and Tr::eq(spec[i], '0')) {
+        result.zero = true, ++i;
+    }
+
+    bool failed = false;
+    const auto fail = [&](const char* what) {
+        failed = true;
+        error(what);
+    };
+
+    result.width = _parseSpecNumber(spec, i, fail);
+    if (failed) return result;
+
+    if (i < spec.size() and Tr::eq(spec[i], '.')) {
+        const size_t digits = ++i;
+        result.precision = static_cast<int>(_parseSpecNumber(spec, i, fail));
+        if (failed) return result;
+        if (i == digits) {
+            error("Format spec precision is missing");
+            return result;
+        }
+    }
+
+    if (i < spec.size() and isOneOf(types, spec[i])) {
+        result.type = static_cast<char>(spec[i++]);
+    }
+
+    if (i != spec.size()) error("Invalid format spec");
+
+    return result;
+}
+
+template <class T, class Ch>
+concept _format_char =
+    std::same_as<T, Ch> or std::same_as<T, char> or
+    std::same_as<T, signed char> or std::same_as<T, unsigned char>;
+
+/**
+ * @brief Checks that spec can be applied to values of type T
+ *
+ * @tparam Ch char type of format
+ * @tparam T argument type
+ * @param spec parsed spec
+ */
+template <class Ch, class T>
+constexpr void _checkSpec(const format_spec& spec) {
+    constexpr std::string_view integers = "bBcdoxX";
+    constexpr std::string_view floats = "aAeEfFgG";
+
+    auto allowed = [&](std::string_view types) {
+        return spec.type == '\0' or types.find(spec.type) != types.npos;
+    };
+
+    if constexpr (std::same_as<T, bool>) {
+        if (not allowed("sbBcdoxX")) {
+            _formatError("Invalid format spec type for bool");
+        }
+    } else if constexpr (_format_char<T, Ch>) {
+        if (not allowed(integers)) {
+            _formatError("Invalid format spec type for char");
+        }
+    } else if constexpr (std::integral<T>) {
+        if (not allowed(integers)) {
+            _formatError("Invalid format spec type for integer");
+        }
+    } else if constexpr (std::floating_point<T>) {
+        if (not allowed(floats)) {
+            _formatError("Invalid format spec type for floating point");
+        }
+    } else if constexpr (std::convertible_to<const T&,
+                                             std::basic_string_view<Ch>>) {
+        if (not allowed("s")) {
+            _formatError("Invalid format spec type for string");
+        }
+    } else {
+        if (spec.type != '\0' or spec.sign != '\0' or spec.alternate or
+            spec.zero or spec.precision >= 0) {
+            _formatError("Only fill, align and width are "
+                         "allowed for printable types");
+        }
+    }
+
+    const bool number = std::is_arithmetic_v<T> and spec.type != 'c' and
+                        spec.type != 's' and
+                        (spec.type != '\0' or not _format_char<T, Ch>);
+    if (not number and (spec.sign != '\0' or spec.alternate or spec.zero)) {
+        _formatError("Sign, '#' and '0' are allowed only for numbers");
+    }
+
+    if constexpr (std::integral<T>) {
+        if (spec.precision >= 0) {
+            _formatError("Precision is not allowed for integers");
         }
-        os << *fmt;
     }
 }
 
+template <class Ch, class Tr>
+constexpr bool _isDigits(std::basic_string_view<Ch, Tr> id) {
+    return not id.empty() and std::ranges::all_of(id, [](Ch ch) {
+        return not Tr::lt(ch, Ch('0')) and not Tr::lt(Ch('9'), ch);
+    });
+}
+
+template <class Ch, class Tr>
+constexpr bool _isIdentifier(std::basic_string_view<Ch, Tr> id) {
+    auto isLetter = [](Ch ch) {
+        return Tr::eq(ch, '_') or
+               (not Tr::lt(ch, Ch('a')) and not Tr::lt(Ch('z'), ch)) or
+               (not Tr::lt(ch, Ch('A')) and not Tr::lt(Ch('Z'), ch));
+    };
+    return not id.empty() and isLetter(id.front()) and
+           std::ranges::all_of(id, [&](Ch ch) {
+               return isLetter(ch) or
+                      (not Tr::lt(ch, Ch('0')) and not Tr::lt(Ch('9'), ch));
+           });
+}
+
+/**
+ * @brief Finds next replace anchor in format, one of '{}', '{index}' or
+ * '{name}' optionally followed by ':spec' before closing '}',
+ * any other '{' is kept as literal text. So is '{index:spec}' or
+ * '{name:spec}' with spec which does not parse, e.g. '{key:value}',
+ * while invalid spec of '{:spec}' is an error
+ *
+ * @param format format string
+ * @param from position to search from
+ * @param id receives argument index or name of found anchor,
+ * empty for the next argument in order
+ * @param spec receives parsed spec of found anchor
+ * @param end receives position past found anchor
+ * @return size_t position of anchor or npos if there is none
+ */
+template <class Ch, class Tr>
+constexpr size_t _findAnchor(std::basic_string_view<Ch, Tr> format,
+                             size_t from, std::basic_string_view<Ch, Tr>& id,
+                             format_spec& spec, size_t& end) {
+    for (size_t i = from; i + 1 < format.size(); ++i) {
+        if (not Tr::eq(format[i], '{')) continue;
+
+        size_t close = i + 1;
+        while (close < format.size() and not Tr::eq(format[close], '}') and
+               not Tr::eq(format[close], ':') and
+               not Tr::eq(format[close], '{')) {
+            ++close;
+        }
+        if (close == format.size() or Tr::eq(format[close], '{')) continue;
+
+        id = format.substr(i + 1, close - i - 1);
+        if (not id.empty() and not _isDigits(id) and not _isIdentifier(id)) {
+            continue;
+        }
+
+        spec = {};
+        if (Tr::eq(format[close], ':')) {
+            bool literal = false;
+            const auto error = [&](const char* what) {
+                if (id.empty()) _formatError(what);
+                literal = true;
+            };
+
+            const auto specBegin = close + 1;
+            close = format.find(Ch('}'), specBegin);
+            if (close == format.npos) {
+                error("Format spec is missing closing '}'");
+            } else {
+                spec = _parseSpec(format.substr(specBegin, close - specBegin),
+                                  error);
+            }
+            if (literal) continue;
+        }
+
+        end = close + 1;
+        return i;
+    }
+    return format.npos;
+}
+
+/**
+ * @brief Splits format into literal chunks and '{}' replace anchors.
+ * Calls handler.text(chunk) for each literal chunk (including empty ones)
+ * and handler.argument(id, spec) for each anchor in between, so there is
+ * always one more chunk than anchors
+ *
+ * @param format format string
+ * @param handler object with text(std::basic_string_view<Ch>) and
+ * argument(std::basic_string_view<Ch>, const format_spec&) methods
+ */
+template <class Ch, class Tr, class Handler>
+constexpr void _parseFormat(std::basic_string_view<Ch, Tr> format,
+                            Handler&& handler) {
+    std::basic_string_view<Ch, Tr> id;
+    format_spec spec;
+    size_t begin = 0;
+    size_t end = 0;
+    for (size_t i = _findAnchor(format, begin, id, spec, end);
+         i != format.npos;
+         i = _findAnchor(format, begin, id, spec, end)) {
+        handler.text(format.substr(begin, i - begin));
+        handler.argument(id, spec);
+        begin = end;
+    }
+    handler.text(format.substr(begin));
+}
+
+/**
+ * @brief Resolves anchor ids into argument indices, '{}' anchors take
+ * arguments in order and can not be mixed with '{index}' ones, '{name}'
+ * anchors can be used with either
+ *
+ */
+struct _ArgIndexer {
+    size_t next = 0;
+    bool automatic = false;
+    bool manual = false;
+
+    /**
+     * @param id anchor id
+     * @param count number of arguments
+     * @param nameOf callable returning std::string_view name of i-th
+     * argument, empty if it has none
+     * @return size_t index of argument, npos if there is no such argument
+     */
+    template <class Ch, class Tr, class NameOf>
+    constexpr size_t operator()(std::basic_string_view<Ch, Tr> id,
+                                size_t count, NameOf&& nameOf) {
+        if (id.empty()) {
+            if (manual) {
+                _formatError("Can not mix '{}' and '{index}' anchors");
+            }
+            automatic = true;
+            return next < count ? next++ : std::string_view::npos;
+        }
+
+        if (_isDigits(id)) {
+            if (automatic) {
+                _formatError("Can not mix '{}' and '{index}' anchors");
+            }
+            manual = true;
+            size_t i = 0;
+            const size_t index = _parseSpecNumber(id, i);
+            return index < count ? index : std::string_view::npos;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            const std::string_view name = nameOf(i);
+            if (name.size() == id.size() and
+                std::equal(name.begin(), name.end(), id.begin(),
+                           [](char lhs, Ch rhs) {
+                               return Tr::eq(Ch(lhs), rhs);
+                           })) {
+                return i;
+            }
+        }
+        return std::string_view::npos;
+    }
+};
+
+template <size_t N>
+struct _fixed_string {
+    char data[N]{};
+
+    constexpr _fixed_string(const char (&str)[N]) {
+        std::copy_n(str, N, data);
+    }
+
+    constexpr std::string_view view() const { return {data, N - 1}; }
+};
+
+template <class Ch, class Tr, class View>
+void _write(std::basic_ostream<Ch, Tr>& os, const View& chunk) {
+    if (not chunk.empty()) os.write(chunk.data(), chunk.size());
+}
+
 }  // namespace detail
 
+/**
+ * @brief Argument referenced by name from '{name}' anchors,
+ * created with my::arg<"name">(value) or "name"_a = value
+ *
+ * @note holds reference to value, so it should not outlive the call
+ *
+ * @tparam Name name of argument, valid identifier
+ * @tparam T type of value
+ */
+template <detail::_fixed_string Name, class T>
+struct named_arg {
+    static_assert(detail::_isIdentifier(Name.view()),
+                  "Argument name must be valid identifier");
+
+    static constexpr std::string_view name = Name.view();
+
+    const T& value;
+
+    template <class Ch, class Tr>
+        requires my::printable<T, std::basic_ostream<Ch, Tr>>
+    friend auto& operator<<(std::basic_ostream<Ch, Tr>& os,
+                            const named_arg& obj) {
+        return os << obj.value;
+    }
+};
+
+/**
+ * @brief Names argument, so format can refer to it as '{name}'
+ *
+ * #Example:
+ * my::printf("{user} has {count} messages\n",
+ *            my::arg<"user">(name), my::arg<"count">(count));
+ *
+ * @tparam Name name of argument
+ * @param value argument
+ */
+template <detail::_fixed_string Name, class T>
+constexpr auto arg(const T& value) {
+    return named_arg<Name, T>{value};
+}
+
+namespace detail {
+
+template <class T>
+struct _unwrap_arg {
+    using type = T;
+    static constexpr std::string_view name{};
+
+    static constexpr const T& get(const T& value) { return value; }
+};
+
+template <_fixed_string Name, class T>
+struct _unwrap_arg<named_arg<Name, T>> {
+    using type = T;
+    static constexpr std::string_view name = Name.view();
+
+    static constexpr const T& get(const named_arg<Name, T>& arg) {
+        return arg.value;
+    }
+};
+
+template <class Arg>
+using _unwrap_arg_t =
+    std::remove_cvref_t<typename _unwrap_arg<std::remove_cvref_t<Arg>>::type>;
+
+template <class Arg>
+constexpr decltype(auto) _unwrapArg(const Arg& arg) {
+    return _unwrap_arg<std::remove_cvref_t<Arg>>::get(arg);
+}
+
+template <_fixed_string Name>
+struct _named_arg_builder {
+    template <class T>
+    constexpr auto operator=(const T& value) const {
+        return named_arg<Name, T>{value};
+    }
+};
+
+}  // namespace detail
+
+/**
+ * @brief Format string checked at compile time.
+ * Constructed implicitly from string literal, layout of '{}' replace
+ * anchors is resolved during compilation into literal chunks written with
+ * single write() each, and the number of anchors must match the number of
+ * arguments, otherwise program does not compile.
+ * Anchor may carry spec '{:[[fill]align][sign][#][0][width][.precision][type]}'
+ * (see my::format_spec), it is parsed and checked against the type of
+ * its argument during compilation as well.
+ * Arguments can also be referenced by position '{0}' or by name '{name}'
+ * (see my::arg), any of them can be used many times or not at all then.
+ *
+ * #Example:
+ * my::printf("{} + {} = {}\n", 1, 2, 3); // ok
+ * my::printf("{} + {} = {}\n", 1, 2); // compile error
+ * my::printf("{:08x} {:.3f} {:>10}\n", 255, 3.14159, "right"); // ok
+ * my::printf("{:.3f}\n", "text"); // compile error
+ * my::printf("{1} {0} {1}\n", "a", "b"); // prints "b a b"
+ * my::printf("{x:.1f}\n", my::arg<"x">(3.14159)); // prints "3.1"
+ *
+ * @note runtime strings (const Ch*) are still accepted by my::printf
+ * and my::format, they are scanned on each call
+ *
+ * @tparam Ch char type
+ * @tparam Args types of arguments
+ */
+template <class Ch, class... Args>
+class basic_format_string {
+   public:
+    using string_view_t = std::basic_string_view<Ch>;
+
+    template <size_t N>
+    consteval basic_format_string(const Ch (&format)[N])
+        : _format(format, N - 1) {
+        struct {
+            std::array<string_view_t, sizeof...(Args) + 1>& chunks;
+            std::array<format_spec, sizeof...(Args) + 1>& specs;
+            size_t texts = 0;
+            size_t arguments = 0;
+            bool indexed = false;
+
+            constexpr void text(string_view_t chunk) {
+                if (texts < chunks.size()) chunks[texts] = chunk;
+                ++texts;
+            }
+            constexpr void argument(string_view_t id,
+                                    const format_spec& spec) {
+                if (arguments < specs.size()) specs[arguments] = spec;
+                ++arguments;
+                indexed = indexed or not id.empty();
+            }
+        } layout{_chunks, _specs};
+
+        detail::_parseFormat(_format, layout);
+
+        _indexed = layout.indexed or
+                   (not detail::_unwrap_arg<
+                        std::remove_cvref_t<Args>>::name.empty() or
+                    ...);
+
+        if (_indexed) {
+            _checkIndexed();
+            return;
+        }
+
+        if (layout.arguments != sizeof...(Args)) {
+            throw "Number of '{}' in format string must match "
+                  "the number of arguments";
+        }
+
+        size_t i = 0;
+        (detail::_checkSpec<Ch, detail::_unwrap_arg_t<Args>>(_specs[i++]),
+         ...);
+    }
+
+    /**
+     * @return Whole format string
+     */
+    constexpr string_view_t get() const noexcept { return _format; }
+
+    /**
+     * @return Literal chunks surrounding replace anchors,
+     * i-th argument goes between chunks i and i + 1
+     */
+    constexpr const auto& chunks() const noexcept { return _chunks; }
+
+    /**
+     * @return Specs of replace anchors, i-th one applies to i-th argument
+     */
+    constexpr const auto& specs() const noexcept { return _specs; }
+
+    /**
+     * @return true if format refers to arguments by index or name,
+     * chunks() and specs() are not filled then and format is emitted
+     * through type erased argument array instead
+     */
+    constexpr bool indexed() const noexcept { return _indexed; }
+
+   private:
+    // resolves every '{index}' and '{name}' anchor and checks its spec
+    // against the type of referenced argument
+    consteval void _checkIndexed() const {
+        using check_t = void (*)(const format_spec&);
+
+        constexpr std::array<std::string_view, sizeof...(Args) + 1> names{
+            detail::_unwrap_arg<std::remove_cvref_t<Args>>::name..., {}};
+        constexpr std::array<check_t, sizeof...(Args) + 1> checks{
+            &detail::_checkSpec<Ch, detail::_unwrap_arg_t<Args>>..., nullptr};
+
+        struct {
+            const std::array<std::string_view, sizeof...(Args) + 1>& names;
+            const std::array<check_t, sizeof...(Args) + 1>& checks;
+            detail::_ArgIndexer indexer{};
+
+            constexpr void text(string_view_t) {}
+            constexpr void argument(string_view_t id,
+                                    const format_spec& spec) {
+                const auto index = indexer(
+                    id, sizeof...(Args), [&](size_t i) { return names[i]; });
+                if (index == id.npos and id.empty()) {
+                    throw "Number of '{}' in format string exceeds "
+                          "the number of arguments";
+                }
+                if (index == id.npos) {
+                    throw "Format refers to argument which is not provided";
+                }
+                checks[index](spec);
+            }
+        } validator{names, checks};
+
+        detail::_parseFormat(_format, validator);
+    }
+
+    string_view_t _format;
+    bool _indexed = false;
+    std::array<string_view_t, sizeof...(Args) + 1> _chunks{};
+    // one extra so the array is never empty
+    std::array<format_spec, sizeof...(Args) + 1> _specs{};
+};
+
+template <class... Args>
+using format_string = basic_format_string<char, std::type_identity_t<Args>...>;
+
+template <class... Args>
+using wformat_string =
+    basic_format_string<wchar_t, std::type_identity_t<Args>...>;
+
+namespace detail {
+
+/**
+ * @brief Stream buffer appending everything to the string, lets user types
+ * with only operator<< print straight into format buffer
+ *
+ */
+template <class Ch, class Tr = std::char_traits<Ch>>
+class _StringAppendBuf : public std::basic_streambuf<Ch, Tr> {
+   public:
+    using traits_type = Tr;
+    using int_type = typename traits_type::int_type;
+
+    explicit _StringAppendBuf(std::basic_string<Ch, Tr>& out)
+        : _out(out) {
+    }
+
+   protected:
+    int_type overflow(int_type ch) override {
+        if (not traits_type::eq_int_type(ch, traits_type::eof())) {
+            _out.push_back(traits_type::to_char_type(ch));
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const Ch* data, std::streamsize size) override {
+        _out.append(data, static_cast<size_t>(size));
+        return size;
+    }
+
+   private:
+    std::basic_string<Ch, Tr>& _out;
+};
+
+template <class Ch>
+void _appendNarrow(std::basic_string<Ch>& out,
+                   const char* first, const char* last) {
+    if constexpr (std::same_as<Ch, char>) {
+        out.append(first, last);
+    } else {
+        for (; first != last; ++first) out.push_back(static_cast<Ch>(*first));
+    }
+}
+
+/**
+ * @brief Appends argument the way default constructed std::basic_ostream
+ * would print it: arithmetic types with std::to_chars (floats in general
+ * format with precision of 6), strings and chars as-is, everything else
+ * with operator<< through stream over the same buffer
+ *
+ * @param out buffer to append to
+ * @param arg argument to print
+ */
+template <class Ch, class Arg>
+void _formatArg(std::basic_string<Ch>& out, const Arg& arg) {
+    using T = std::remove_cvref_t<Arg>;
+
+    if constexpr (std::same_as<T, bool>) {
+        out.push_back(arg ? Ch('1') : Ch('0'));
+    } else if constexpr (std::same_as<T, Ch> or std::same_as<T, char> or
+                         std::same_as<T, signed char> or
+                         std::same_as<T, unsigned char>) {
+        out.push_back(static_cast<Ch>(arg));
+    } else if constexpr (std::integral<T>) {
+        std::array<char, std::numeric_limits<T>::digits10 + 3> buffer;
+        const auto end =
+            std::to_chars(buffer.data(), buffer.data() + buffer.size(), arg)
+                .ptr;
+        _appendNarrow(out, buffer.data(), end);
+    } else if constexpr (std::floating_point<T>) {
+        std::array<char, 64> buffer;
+        const auto end =
+            std::to_chars(buffer.data(), buffer.data() + buffer.size(), arg,
+                          std::chars_format::general, 6)
+                .ptr;
+        _appendNarrow(out, buffer.data(), end);
+    } else if constexpr (std::convertible_to<const T&,
+                                             std::basic_string_view<Ch>>) {
+        out.append(std::basic_string_view<Ch>(arg));
+    } else {
+        _StringAppendBuf<Ch> buffer(out);
+        std::basic_ostream<Ch> os(&buffer);
+        os << arg;
+    }
+}
+
+/**
+ * @brief Pads value appended to out starting at position start up to the
+ * width of spec
+ *
+ * @param out buffer
+ * @param start position where value begins
+ * @param spec spec of value
+ * @param align alignment used if spec has none
+ * @param zeroAt offset from start where '0' padding goes, npos if value
+ * can not be padded with zeros
+ */
+template <class Ch>
+void _pad(std::basic_string<Ch>& out, size_t start, const format_spec& spec,
+          char align, size_t zeroAt) {
+    const size_t size = out.size() - start;
+    if (size >= spec.width) return;
+
+    const size_t padding = spec.width - size;
+
+    if (spec.zero and spec.align == '\0' and zeroAt != out.npos) {
+        out.insert(start + zeroAt, padding, Ch('0'));
+        return;
+    }
+
+    if (spec.align != '\0') align = spec.align;
+
+    const size_t before = align == '>'   ? padding
+                          : align == '^' ? padding / 2
+                                         : 0;
+    const auto fill = static_cast<Ch>(spec.fill);
+    out.insert(start, before, fill);
+    out.append(padding - before, fill);
+}
+
+template <class Ch, std::integral T>
+void _formatInteger(std::basic_string<Ch>& out, T value,
+                    const format_spec& spec) {
+    using U = std::make_unsigned_t<T>;
+
+    const size_t start = out.size();
+
+    if (spec.type == 'c') {
+        out.push_back(static_cast<Ch>(value));
+        _pad(out, start, spec, '<', out.npos);
+        return;
+    }
+
+    bool negative = false;
+    if constexpr (std::is_signed_v<T>) negative = value < 0;
+
+    U magnitude = static_cast<U>(value);
+    if (negative) {
+        magnitude = U(0) - magnitude;
+        out.push_back(Ch('-'));
+    } else if (spec.sign == '+' or spec.sign == ' ') {
+        out.push_back(static_cast<Ch>(spec.sign));
+    }
+
+    int base = 10;
+    const char* prefix = "";
+    switch (spec.type) {
+        case 'b': base = 2, prefix = "0b"; break;
+        case 'B': base = 2, prefix = "0B"; break;
+        case 'o': base = 8, prefix = magnitude ? "0" : ""; break;
+        case 'x': base = 16, prefix = "0x"; break;
+        case 'X': base = 16, prefix = "0X"; break;
+    }
+    if (spec.alternate) {
+        _appendNarrow(out, prefix, prefix + std::strlen(prefix));
+    }
+
+    const size_t zeroAt = out.size() - start;
+
+    std::array<char, std::numeric_limits<U>::digits + 1> buffer;
+    const auto end = std::to_chars(buffer.data(),
+                                   buffer.data() + buffer.size(),
+                                   magnitude, base)
+                         .ptr;
+    if (spec.type == 'X') {
+        std::transform(buffer.data(), end, buffer.data(), [](char ch) {
+            return ch >= 'a' ? static_cast<char>(ch - 'a' + 'A') : ch;
+        });
+    }
+    _appendNarrow(out, buffer.data(), end);
+
+    _pad(out, start, spec, '>', zeroAt);
+}
+
+template <class Ch, std::floating_point T>
+void _formatFloatingPoint(std::basic_string<Ch>& out, T value,
+                          const format_spec& spec) {
+    const size_t start = out.size();
+
+    if (std::signbit(value)) {
+        value = -value;
+        out.push_back(Ch('-'));
+    } else if (spec.sign == '+' or spec.sign == ' ') {
+        out.push_back(static_cast<Ch>(spec.sign));
+    }
+
+    const size_t zeroAt = std::isfinite(value) ? out.size() - start
+                                               : out.npos;
+
+    auto format = std::chars_format::general;
+    int precision = spec.precision < 0 ? 6 : spec.precision;
+    switch (spec.type) {
+        case 'a': case 'A':
+            format = std::chars_format::hex;
+            precision = spec.precision;
+            break;
+        case 'e': case 'E': format = std::chars_format::scientific; break;
+        case 'f': case 'F': format = std::chars_format::fixed; break;
+    }
+
+    auto convert = [&](char* first, char* last) {
+        return precision < 0
+                   ? std::to_chars(first, last, value, format)
+                   : std::to_chars(first, last, value, format, precision);
+    };
+
+    // long fixed values and high precisions do not fit small buffer
+    std::array<char, 128> small;
+    std::string large;
+    char* first = small.data();
+    auto [last, error] = convert(small.data(), small.data() + small.size());
+    if (error == std::errc::value_too_large) {
+        large.resize(std::numeric_limits<T>::max_exponent10 +
+                     std::max(precision, 0) + 16);
+        first = large.data();
+        last = convert(large.data(), large.data() + large.size()).ptr;
+    }
+
+    if (std::isupper(static_cast<unsigned char>(spec.type))) {
+        std::transform(first, last, first, [](char ch) {
+            return ch >= 'a' ? static_cast<char>(ch - 'a' + 'A') : ch;
+        });
+    }
+
+    const auto exponent = std::find_if(first, last, [](char ch) {
+        return ch == 'e' or ch == 'E' or ch == 'p' or ch == 'P';
+    });
+    if (spec.alternate and zeroAt != out.npos and
+        std::find(first, exponent, '.') == exponent) {
+        _appendNarrow(out, first, exponent);
+        out.push_back(Ch('.'));
+        _appendNarrow(out, exponent, last);
+    } else {
+        _appendNarrow(out, first, last);
+    }
+
+    _pad(out, start, spec, '>', zeroAt);
+}
+
+/**
+ * @brief Appends argument formatted according to spec, digits are
+ * generated straight into out, only types printable with operator<< alone
+ * go through stream and are padded afterwards
+ *
+ * @param out buffer to append to
+ * @param arg argument to print
+ * @param spec spec checked with _checkSpec against the type of arg
+ */
+template <class Ch, class Arg>
+void _formatArg(std::basic_string<Ch>& out, const Arg& arg,
+                const format_spec& spec) {
+    using T = std::remove_cvref_t<Arg>;
+
+    if (spec.empty()) return _formatArg(out, arg);
+
+    const size_t start = out.size();
+
+    if constexpr (std::same_as<T, bool>) {
+        if (spec.type == 's') {
+            const std::string_view text = arg ? "true" : "false";
+            _appendNarrow(out, text.data(), text.data() + text.size());
+            _pad(out, start, spec, '<', out.npos);
+        } else {
+            _formatInteger(out, static_cast<int>(arg), spec);
+        }
+    } else if constexpr (_format_char<T, Ch>) {
+        if (spec.type == '\0' or spec.type == 'c') {
+            out.push_back(static_cast<Ch>(arg));
+            _pad(out, start, spec, '<', out.npos);
+        } else if constexpr (std::same_as<T, signed char>) {
+            _formatInteger(out, static_cast<int>(arg), spec);
+        } else {
+            // char and wchar_t are code units, their numbers are unsigned
+            _formatInteger(out, static_cast<std::make_unsigned_t<T>>(arg),
+                           spec);
+        }
+    } else if constexpr (std::integral<T>) {
+        _formatInteger(out, arg, spec);
+    } else if constexpr (std::floating_point<T>) {
+        _formatFloatingPoint(out, arg, spec);
+    } else if constexpr (std::convertible_to<const T&,
+                                             std::basic_string_view<Ch>>) {
+        const std::basic_string_view<Ch> view(arg);
+        out.append(spec.precision < 0
+                       ? view
+                       : view.substr(0, static_cast<size_t>(spec.precision)));
+        _pad(out, start, spec, '<', out.npos);
+    } else {
+        _formatArg(out, arg);
+        _pad(out, start, spec, '<', out.npos);
+    }
+}
+
+// scratch buffer of format_to(OutputIt), it is taken for the time of call
+// so nested calls from user operator<< just start with empty one
+template <class Ch>
+std::basic_string<Ch>& _formatBuffer() {
+    thread_local std::basic_string<Ch> buffer;
+    return buffer;
+}
+
+template <class Ch, class Tr, class Arg>
+void _printArg(std::basic_ostream<Ch, Tr>& os, Arg&& arg,
+               const format_spec& spec) {
+    if (spec.empty()) {
+        os << std::forward<Arg>(arg);
+        return;
+    }
+    auto buffer = std::exchange(_formatBuffer<Ch>(), {});
+    buffer.clear();
+    _formatArg(buffer, arg, spec);
+    _write(os, buffer);
+    _formatBuffer<Ch>() = std::move(buffer);
+}
+
+/**
+ * @brief Type erased argument, pointer to value with functions able
+ * to check spec against its type and to print it.
+ * Array of them lets one loop emit any format without instantiating
+ * anything per argument position
+ *
+ */
+template <class Ch, class Tr = std::char_traits<Ch>>
+struct _format_arg {
+    const void* value;
+    std::string_view name;
+    void (*check)(const format_spec&);
+    void (*format)(std::basic_string<Ch>&, const void*, const format_spec&);
+    void (*print)(std::basic_ostream<Ch, Tr>&, const void*,
+                  const format_spec&);
+};
+
+template <class Ch, class T>
+void _formatErased(std::basic_string<Ch>& out, const void* value,
+                   const format_spec& spec) {
+    _formatArg(out, *static_cast<const T*>(value), spec);
+}
+
+template <class Ch, class Tr, class T>
+void _printErased(std::basic_ostream<Ch, Tr>& os, const void* value,
+                  const format_spec& spec) {
+    _printArg(os, *static_cast<const T*>(value), spec);
+}
+
+template <class Ch, class Tr, class Arg>
+constexpr _format_arg<Ch, Tr> _eraseArg(const Arg& arg) {
+    using T = _unwrap_arg_t<Arg>;
+    return {std::addressof(_unwrapArg(arg)),
+            _unwrap_arg<std::remove_cvref_t<Arg>>::name,
+            &_checkSpec<Ch, T>,
+            &_formatErased<Ch, T>,
+            &_printErased<Ch, Tr, T>};
+}
+
+template <class Ch, class Tr = std::char_traits<Ch>, class... Args>
+constexpr auto _makeFormatArgs(const Args&... args) {
+    return std::array<_format_arg<Ch, Tr>, sizeof...(Args)>{
+        _eraseArg<Ch, Tr>(args)...};
+}
+
+/**
+ * @brief Walks format once, calling text(chunk) for literal chunks and
+ * argument(arg, spec) for each anchor with argument it refers to.
+ * Anchors referring to arguments which are not provided are kept in the
+ * output as they are
+ * @note throws std::invalid_argument if spec does not suit the argument
+ *
+ */
+template <class Ch, class Tr, class Text, class Argument>
+void _emitFormat(std::basic_string_view<Ch, Tr> format,
+                 std::span<const _format_arg<Ch, Tr>> args,
+                 Text&& text, Argument&& argument) {
+    _ArgIndexer indexer;
+    std::basic_string_view<Ch, Tr> id;
+    format_spec spec;
+    size_t begin = 0;
+    size_t end = 0;
+    for (size_t i = _findAnchor(format, begin, id, spec, end);
+         i != format.npos;
+         i = _findAnchor(format, begin, id, spec, end)) {
+        const auto index = indexer(id, args.size(), [&](size_t i) {
+            return args[i].name;
+        });
+        if (index == format.npos) {
+            text(format.substr(begin, end - begin));
+        } else {
+            text(format.substr(begin, i - begin));
+            args[index].check(spec);
+            argument(args[index], spec);
+        }
+        begin = end;
+    }
+    text(format.substr(begin));
+}
+
+template <class Ch>
+void _vformatTo(std::basic_string<Ch>& out, std::basic_string_view<Ch> format,
+                std::span<const _format_arg<Ch>> args) {
+    _emitFormat(
+        format, args,
+        [&](std::basic_string_view<Ch> chunk) { out.append(chunk); },
+        [&](const _format_arg<Ch>& arg, const format_spec& spec) {
+            arg.format(out, arg.value, spec);
+        });
+}
+
+template <class Ch, class Tr>
+void _vprintf(std::basic_ostream<Ch, Tr>& os,
+              std::basic_string_view<Ch, Tr> format,
+              std::span<const _format_arg<Ch, Tr>> args) {
+    _emitFormat(
+        format, args,
+        [&](std::basic_string_view<Ch, Tr> chunk) { _write(os, chunk); },
+        [&](const _format_arg<Ch, Tr>& arg, const format_spec& spec) {
+            arg.print(os, arg.value, spec);
+        });
+}
+
+template <class Ch, class... Fmt, class... Args, size_t... I>
+void _formatTo(std::basic_string<Ch>& out,
+               const basic_format_string<Ch, Fmt...>& format,
+               std::index_sequence<I...>, const Args&... args) {
+    if (format.indexed()) {
+        const auto erased = _makeFormatArgs<Ch>(args...);
+        return _vformatTo(out, format.get(),
+                          std::span<const _format_arg<Ch>>(erased));
+    }
+    const auto& chunks = format.chunks();
+    const auto& specs = format.specs();
+    ((out.append(chunks[I]), _formatArg(out, _unwrapArg(args), specs[I])),
+     ...);
+    out.append(chunks.back());
+}
+
+template <class Ch, class OutputIt, class... Fmt, class... Args>
+OutputIt _formatToIterator(OutputIt out,
+                           const basic_format_string<Ch, Fmt...>& format,
+                           const Args&... args) {
+    auto buffer = std::exchange(_formatBuffer<Ch>(), {});
+    buffer.clear();
+    _formatTo(buffer, format, std::index_sequence_for<Args...>(), args...);
+    out = std::copy(buffer.begin(), buffer.end(), std::move(out));
+    _formatBuffer<Ch>() = std::move(buffer);
+    return out;
+}
+
+template <class Ch, class... Args>
+size_t _formatReserve(std::basic_string_view<Ch> format) {
+    return format.size() + sizeof...(Args) * 8;
+}
+
+template <class Ch, class Tr, class... Fmt, class... Args, size_t... I>
+void _printf(std::basic_ostream<Ch, Tr>& os,
+             const basic_format_string<Ch, Fmt...>& format,
+             std::index_sequence<I...>, Args&&... args) {
+    if (format.indexed()) {
+        const auto erased = _makeFormatArgs<Ch, Tr>(args...);
+        return _vprintf(os, std::basic_string_view<Ch, Tr>(format.get()),
+                        std::span<const _format_arg<Ch, Tr>>(erased));
+    }
+    const auto& chunks = format.chunks();
+    const auto& specs = format.specs();
+    ((_write(os, chunks[I]),
+      _printArg(os, std::forward<Args>(args), specs[I])),
+     ...);
+    _write(os, chunks.back());
+}
+
+// pointers and arrays of mutable chars can not be checked at compile time,
+// arrays of const chars are string literals
+template <class Format>
+concept _runtime_format =
+    std::is_pointer_v<std::remove_cvref_t<Format>> or
+    (std::is_array_v<std::remove_reference_t<Format>> and
+     not std::is_const_v<
+         std::remove_extent_t<std::remove_reference_t<Format>>>);
+
+template <class Format>
+using _format_char_t =
+    std::remove_cv_t<std::remove_pointer_t<std::decay_t<Format>>>;
+
+}  // namespace detail
+
+/**
+ * @brief Type erased arguments made by my::make_format_args
+ *
+ */
+template <class Ch, class Tr = std::char_traits<Ch>>
+using basic_format_args = std::span<const detail::_format_arg<Ch, Tr>>;
+
+using format_args = basic_format_args<char>;
+using wformat_args = basic_format_args<wchar_t>;
+
+/**
+ * @brief Type erases arguments into array which can be passed to
+ * my::vformat, my::vformat_to and my::vprintf any number of times,
+ * for example to emit localized templates known only at runtime
+ *
+ * #Example:
+ * const auto args = my::make_format_args(my::arg<"user">(user), count);
+ * for (auto&& language : languages) {
+ *     my::vprintf(std::cout, templates[language], args);
+ * }
+ *
+ * @note array refers to the arguments, so it must not outlive them
+ *
+ * @tparam Ch char type of format strings
+ * @param args any printable types, optionally named with my::arg
+ * @return std::array of type erased arguments, convertible to
+ * my::basic_format_args<Ch, Tr>
+ */
+template <class Ch = char, class Tr = std::char_traits<Ch>,
+          my::printable<std::basic_ostream<Ch, Tr>>... Args>
+[[nodiscard]] constexpr auto make_format_args(const Args&... args) {
+    return detail::_makeFormatArgs<Ch, Tr>(args...);
+}
+
+/**
+ * @brief Appends format with type erased arguments to buffer
+ * @note format is scanned on each call, spec errors throw
+ * std::invalid_argument, anchors referring to missing arguments are
+ * kept as they are
+ *
+ * @param buffer string to append to
+ * @param format format with '{}', '{index}' or '{name}' anchors
+ * @param args arguments made by my::make_format_args
+ */
+inline void vformat_to(std::string& buffer, std::string_view format,
+                       format_args args) {
+    detail::_vformatTo(buffer, format, args);
+}
+
+inline void vformat_to(std::wstring& buffer, std::wstring_view format,
+                       wformat_args args) {
+    detail::_vformatTo(buffer, format, args);
+}
+
+/**
+ * @brief Creates new string with format applied to type erased arguments
+ * @note format is scanned on each call, spec errors throw
+ * std::invalid_argument, anchors referring to missing arguments are
+ * kept as they are
+ *
+ * @param format format with '{}', '{index}' or '{name}' anchors
+ * @param args arguments made by my::make_format_args
+ */
+[[nodiscard]] inline std::string vformat(std::string_view format,
+                                         format_args args) {
+    std::string result;
+    detail::_vformatTo(result, format, args);
+    return result;
+}
+
+[[nodiscard]] inline std::wstring vformat(std::wstring_view format,
+                                          wformat_args args) {
+    std::wstring result;
+    detail::_vformatTo(result, format, args);
+    return result;
+}
+
+/**
+ * @brief Prints format with type erased arguments into provided stream
+ * @note format is scanned on each call, spec errors throw
+ * std::invalid_argument, anchors referring to missing arguments are
+ * kept as they are
+ *
+ * @param os stream where to print data
+ * @param format format with '{}', '{index}' or '{name}' anchors
+ * @param args arguments made by my::make_format_args<Ch, Tr>
+ */
+template <class Ch, class Tr>
+void vprintf(std::basic_ostream<Ch, Tr>& os,
+             std::type_identity_t<std::basic_string_view<Ch, Tr>> format,
+             std::type_identity_t<basic_format_args<Ch, Tr>> args) {
+    detail::_vprintf(os, format, args);
+}
+
 /**
  * @brief Prints formatted output into provided std::ostream.
  * Replaces each next '{}' occurance with next argument
  *
  * @tparam Args
  * @param os std::ostream where to print data
- * @param format format c_str where '{}' is a replace anchor
+ * @param format format string literal where '{}' is a replace anchor
  * @param args any printable types
  */
 template <class Ch, class Tr,
           my::printable<std::basic_ostream<Ch, Tr>>... Args>
+constexpr void printf(
+    std::basic_ostream<Ch, Tr>& os,
+    std::type_identity_t<basic_format_string<Ch, Args...>> format,
+    Args&&... args) {
+    detail::_printf(os, format, std::index_sequence_for<Args...>(),
+                    std::forward<Args>(args)...);
+}
+
+/**
+ * @brief Prints formatted output into provided std::ostream.
+ * Replaces each next '{}' occurance with next argument
+ * @note format is scanned on each call, prefer string literals
+ *
+ * @tparam Args
+ * @param os std::ostream where to print data
+ * @param format format c_str where '{}' is a replace anchor
+ * @param args any printable types
+ */
+template <class Ch, class Tr, detail::_runtime_format Format,
+          my::printable<std::basic_ostream<Ch, Tr>>... Args>
+    requires std::same_as<detail::_format_char_t<Format>, Ch>
 constexpr void printf(std::basic_ostream<Ch, Tr>& os,
-                      const Ch* format, Args&&... args) {
-    detail::_printf(os, format, std::forward<Args>(args)...);
+                      Format&& format, Args&&... args) {
+    my::vprintf(os, std::basic_string_view<Ch, Tr>(format),
+                my::make_format_args<Ch, Tr>(args...));
+}
+
+/**
+ * @brief Prints formatted output into std::cout.
+ * Replaces each next '{}' occurance with next argument
+ *
+ * @param format format string literal where '{}' is a replace anchor
+ * @param args any printable types
+ */
+template <my::printable<std::ostream>... Args>
+constexpr void printf(format_string<Args...> format, Args&&... args) {
+    my::printf(std::cout, format, std::forward<Args>(args)...);
+}
+
+/**
+ * @brief Prints formatted output into std::wcout.
+ * Replaces each next '{}' occurance with next argument
+ *
+ * @param format format string literal where '{}' is a replace anchor
+ * @param args any printable types
+ */
+template <my::printable<std::wostream>... Args>
+constexpr void printf(wformat_string<Args...> format, Args&&... args) {
+    my::printf(std::wcout, format, std::forward<Args>(args)...);
 }
 
 /**
  * @brief Prints formatted output into std::cout / std::wcout.
  * Replaces each next '{}' occurance with next argument
+ * @note format is scanned on each call, prefer string literals
  *
  * @param format format c_str where '{}' is a replace anchor
  * @param args any printable types
  */
-template <class Ch, my::printable<std::basic_ostream<Ch>>... Args>
-constexpr void printf(const Ch* format, Args&&... args) {
+template <detail::_runtime_format Format,
+          class Ch = detail::_format_char_t<Format>,
+          my::printable<std::basic_ostream<Ch>>... Args>
+constexpr void printf(Format&& format, Args&&... args) {
     if constexpr (std::same_as<Ch, wchar_t>) {
-        detail::_printf(std::wcout, format, std::forward<Args>(args)...);
+        my::vprintf(std::wcout, format, my::make_format_args<Ch>(args...));
     } else {
-        detail::_printf(std::cout, format, std::forward<Args>(args)...);
+        my::vprintf(std::cout, format, my::make_format_args<Ch>(args...));
     }
 }
 
+/**
+ * @brief Appends formatted output to the end of buffer, so the same buffer
+ * can be reused for many calls without reallocating
+ *
+ * #Example:
+ * std::string line;
+ * my::format_to(line, "{} = {}\n", key, value);
+ *
+ * @param buffer string to append to
+ * @param format format string literal where '{}' is a replace anchor
+ * @param args any types with std::ostream& operator<< implemented
+ */
+template <class Ch, my::printable<std::basic_ostream<Ch>>... Args>
+void format_to(std::basic_string<Ch>& buffer,
+               std::type_identity_t<basic_format_string<Ch, Args...>> format,
+               Args&&... args) {
+    detail::_formatTo(buffer, format, std::index_sequence_for<Args...>(),
+                      args...);
+}
+
+/**
+ * @brief Writes formatted output through output iterator.
+ * Output is built in thread local buffer which keeps its capacity between
+ * calls and is copied into out at once
+ *
+ * #Example:
+ * std::array<char, 256> packet;
+ * auto end = my::format_to(packet.data(), "GET {} HTTP/1.1\r\n", path);
+ *
+ * @param out output iterator
+ * @param format format string literal where '{}' is a replace anchor
+ * @param args any types with std::ostream& operator<< implemented
+ * @return OutputIt iterator past the last written char
+ */
+template <std::output_iterator<const char&> OutputIt,
+          my::printable<std::ostream>... Args>
+OutputIt format_to(OutputIt out, format_string<Args...> format,
+                   Args&&... args) {
+    return detail::_formatToIterator<char>(std::move(out), format, args...);
+}
+
+template <std::output_iterator<const wchar_t&> OutputIt,
+          my::printable<std::wostream>... Args>
+OutputIt format_to(OutputIt out, wformat_string<Args...> format,
+                   Args&&... args) {
+    return detail::_formatToIterator<wchar_t>(std::move(out), format,
+                                              args...);
+}
+
+/**
+ * @brief Creates new std::string object with formatted ouput
+ *
+ * @tparam Args
+ * @param format format string literal where '{}' is a replace anchor
+ * @param args any types with std::ostream& operator<< implemented
+ *
+ * @return std::string new object with printed ouput
+ */
+template <my::printable<std::ostream>... Args>
+[[nodiscard]] inline auto format(format_string<Args...> format,
+                                 Args&&... args) {
+    std::string result;
+    result.reserve(detail::_formatReserve<char, Args...>(format.get()));
+    detail::_formatTo(result, format, std::index_sequence_for<Args...>(),
+                      args...);
+    return result;
+}
+
+/**
+ * @brief Creates new std::wstring object with formatted ouput
+ *
+ * @tparam Args
+ * @param format format string literal where '{}' is a replace anchor
+ * @param args any types with std::wostream& operator<< implemented
+ *
+ * @return std::wstring new object with printed ouput
+ */
+template <my::printable<std::wostream>... Args>
+[[nodiscard]] inline auto format(wformat_string<Args...> format,
+                                 Args&&... args) {
+    std::wstring result;
+    result.reserve(detail::_formatReserve<wchar_t, Args...>(format.get()));
+    detail::_formatTo(result, format, std::index_sequence_for<Args...>(),
+                      args...);
+    return result;
+}
+
 /**
  * @brief Creates new std::string object with formatted ouput
+ * @note format is scanned on each call, prefer string literals
  *
  * @tparam Args
  * @param format format c_str where '{}' is a replace anchor
@@ -75,12 +1396,250 @@ constexpr void printf(const Ch* format, Args&&... args) {
  *
  * @return std::string new object with printed ouput
  */
-template <class Ch,
+template <detail::_runtime_format Format,
+          class Ch = detail::_format_char_t<Format>,
           my::printable<std::basic_ostream<Ch>>... Args>
-[[nodiscard]] inline auto format(const Ch* format, Args&&... args) {
-    std::basic_stringstream<Ch> ss;
-    detail::_printf(ss, format, std::forward<Args>(args)...);
-    return ss.str();
+[[nodiscard]] inline auto format(Format&& format, Args&&... args) {
+    std::basic_string<Ch> result;
+    my::vformat_to(result, format, my::make_format_args<Ch>(args...));
+    return result;
 }
 
-}  // namespace my
\ No newline at end of file
+/**
+ * @brief Format string parsed once at runtime.
+ * Keeps its own copy of format split into literal segments and argument
+ * slots with already parsed specs, so applying it does not scan format
+ * at all. Meant for templates which are not known at compile time but
+ * are used many times, e.g. loaded from config.
+ *
+ * #Example:
+ * const my::compiled_format line(config.at<std::string>("log", "format"));
+ * for (auto&& event : events) {
+ *     my::printf(file, line, my::arg<"time">(event.time), event.message);
+ * }
+ *
+ * @note throws std::invalid_argument on invalid spec or mix of '{}' and
+ * '{index}' anchors; spec is checked against argument type on each use,
+ * slots referring to missing arguments are printed as they are
+ *
+ * @tparam Ch char type
+ */
+template <class Ch>
+class basic_compiled_format {
+   public:
+    using string_t = std::basic_string<Ch>;
+    using string_view_t = std::basic_string_view<Ch>;
+
+    explicit basic_compiled_format(string_view_t format)
+        : _format(format) {
+        const string_view_t view(_format);
+
+        detail::_ArgIndexer indexer;
+        string_view_t id;
+        format_spec spec;
+        size_t begin = 0;
+        size_t end = 0;
+        for (size_t i = detail::_findAnchor(view, begin, id, spec, end);
+             i != view.npos;
+             i = detail::_findAnchor(view, begin, id, spec, end)) {
+            _Slot slot{{begin, i - begin}, {i, end - i}, {}, view.npos, spec};
+            if (detail::_isIdentifier(id)) {
+                slot.name = {static_cast<size_t>(id.data() - view.data()),
+                             id.size()};
+            } else {
+                slot.index = indexer(id, view.npos, [](size_t) {
+                    return std::string_view();
+                });
+            }
+            _slots.push_back(slot);
+            begin = end;
+        }
+        _tail = {begin, view.size() - begin};
+    }
+
+    /**
+     * @return Whole format string
+     */
+    string_view_t get() const noexcept { return _format; }
+
+    /**
+     * @return Number of argument slots
+     */
+    size_t size() const noexcept { return _slots.size(); }
+
+    /**
+     * @return Literal text preceding i-th slot, text after the last slot
+     * if i == size()
+     */
+    string_view_t segment(size_t i) const {
+        return _piece(i < _slots.size() ? _slots[i].text : _tail);
+    }
+
+    /**
+     * @return Spec of i-th slot
+     */
+    const format_spec& spec(size_t i) const { return _slots[i].spec; }
+
+    /**
+     * @brief Appends format applied to type erased arguments to buffer
+     *
+     * @param buffer string to append to
+     * @param args arguments made by my::make_format_args<Ch>
+     */
+    void vformat_to(string_t& buffer, basic_format_args<Ch> args) const {
+        _emit(
+            args, [&](string_view_t chunk) { buffer.append(chunk); },
+            [&](const detail::_format_arg<Ch>& arg, const format_spec& spec) {
+                arg.format(buffer, arg.value, spec);
+            });
+    }
+
+    /**
+     * @brief Prints format applied to type erased arguments to stream
+     *
+     * @param os stream where to print data
+     * @param args arguments made by my::make_format_args<Ch>
+     */
+    void vprintf(std::basic_ostream<Ch>& os,
+                 basic_format_args<Ch> args) const {
+        _emit(
+            args, [&](string_view_t chunk) { detail::_write(os, chunk); },
+            [&](const detail::_format_arg<Ch>& arg, const format_spec& spec) {
+                arg.print(os, arg.value, spec);
+            });
+    }
+
+   private:
+    // offsets instead of views, so copies do not point into the original
+    struct _Piece {
+        size_t offset = 0;
+        size_t size = 0;
+    };
+
+    struct _Slot {
+        _Piece text;
+        _Piece anchor;
+        _Piece name;
+        size_t index;
+        format_spec spec;
+    };
+
+    string_view_t _piece(_Piece piece) const {
+        return string_view_t(_format).substr(piece.offset, piece.size);
+    }
+
+    size_t _resolve(const _Slot& slot, basic_format_args<Ch> args) const {
+        if (slot.name.size == 0) return slot.index;
+
+        const auto name = _piece(slot.name);
+        for (size_t i = 0; i < args.size(); ++i) {
+            if (args[i].name.size() == name.size() and
+                std::equal(name.begin(), name.end(), args[i].name.begin(),
+                           [](Ch lhs, char rhs) { return lhs == Ch(rhs); })) {
+                return i;
+            }
+        }
+        return name.npos;
+    }
+
+    template <class Text, class Argument>
+    void _emit(basic_format_args<Ch> args,
+               Text&& text, Argument&& argument) const {
+        for (const auto& slot : _slots) {
+            text(_piece(slot.text));
+            const auto index = _resolve(slot, args);
+            if (index < args.size()) {
+                args[index].check(slot.spec);
+                argument(args[index], slot.spec);
+            } else {
+                text(_piece(slot.anchor));
+            }
+        }
+        text(_piece(_tail));
+    }
+
+    string_t _format;
+    std::vector<_Slot> _slots;
+    _Piece _tail;
+};
+
+using compiled_format = basic_compiled_format<char>;
+using wcompiled_format = basic_compiled_format<wchar_t>;
+
+/**
+ * @brief Prints format compiled at runtime into provided std::ostream
+ *
+ * @param os std::ostream where to print data
+ * @param format compiled format
+ * @param args any printable types, optionally named with my::arg
+ */
+template <class Ch, my::printable<std::basic_ostream<Ch>>... Args>
+void printf(std::basic_ostream<Ch>& os,
+            const basic_compiled_format<Ch>& format, const Args&... args) {
+    format.vprintf(os, my::make_format_args<Ch>(args...));
+}
+
+/**
+ * @brief Prints format compiled at runtime into std::cout / std::wcout
+ *
+ * @param format compiled format
+ * @param args any printable types, optionally named with my::arg
+ */
+template <class Ch, my::printable<std::basic_ostream<Ch>>... Args>
+void printf(const basic_compiled_format<Ch>& format, const Args&... args) {
+    if constexpr (std::same_as<Ch, wchar_t>) {
+        format.vprintf(std::wcout, my::make_format_args<Ch>(args...));
+    } else {
+        format.vprintf(std::cout, my::make_format_args<Ch>(args...));
+    }
+}
+
+/**
+ * @brief Appends format compiled at runtime to the end of buffer
+ *
+ * @param buffer string to append to
+ * @param format compiled format
+ * @param args any printable types, optionally named with my::arg
+ */
+template <class Ch, my::printable<std::basic_ostream<Ch>>... Args>
+void format_to(std::basic_string<Ch>& buffer,
+               const basic_compiled_format<Ch>& format, const Args&... args) {
+    format.vformat_to(buffer, my::make_format_args<Ch>(args...));
+}
+
+/**
+ * @brief Creates new string with format compiled at runtime
+ *
+ * @param format compiled format
+ * @param args any printable types, optionally named with my::arg
+ */
+template <class Ch, my::printable<std::basic_ostream<Ch>>... Args>
+[[nodiscard]] auto format(const basic_compiled_format<Ch>& format,
+                          const Args&... args) {
+    std::basic_string<Ch> result;
+    format.vformat_to(result, my::make_format_args<Ch>(args...));
+    return result;
+}
+
+inline namespace literals {
+
+inline namespace format_literals {
+
+/**
+ * @brief Names argument, so format can refer to it as '{name}'
+ *
+ * #Example:
+ * using namespace my::literals;
+ * my::printf("{user} has {count} messages\n",
+ *            "user"_a = name, "count"_a = count);
+ */
+template <detail::_fixed_string Name>
+constexpr auto operator""_a() {
+    return detail::_named_arg_builder<Name>{};
+}
+
+}  // namespace format_literals
+
+}  // namespace literals
+
+}  // namespace my
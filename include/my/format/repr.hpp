@@ -1,5 +1,6 @@
 #pragma once
 
+#include <my/format/format.hpp>
 #include <my/util/concepts.hpp>
 #include <my/util/functional.hpp>
 #include <my/util/utils.hpp>
@@ -8,7 +9,6 @@
 #include <iostream>
 #include <iterator>
 #include <ranges>
-#include <sstream>
 #include <string>
 #include <variant>
 
@@ -105,9 +105,11 @@ template <class Derived>
 struct BaseRepresenter {
     template <class Ch, class Tr, my::representable_with<Derived> T>
     constexpr auto get(const T& value) const {
-        std::basic_stringstream<Ch, Tr> ss;
-        _derived()(ss, value);
-        return ss.str();
+        std::basic_string<Ch, Tr> result;
+        detail::_StringAppendBuf<Ch, Tr> buffer(result);
+        std::basic_ostream<Ch, Tr> os(&buffer);
+        _derived()(os, value);
+        return result;
     }
 
     template <my::representable_with<Derived> T>
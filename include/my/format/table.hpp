@@ -1,15 +1,534 @@
 #pragma once
 
+#include <my/format/display_width.hpp>
 #include <my/format/repr.hpp>
 #include <my/format/symbols.hpp>
 #include <my/util/str_utils.hpp>
 //
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <exception>
+#include <memory>
 #include <ranges>
+#include <thread>
 #include <vector>
 
 namespace my {
 
+/**
+ * @brief Output format of table, footer is left out of Csv, Tsv and
+ * JsonLines output
+ *
+ */
+enum class TableFormat {
+    Box,        // box drawn text of selected my::Style
+    Csv,        // RFC 4180 comma separated values
+    Tsv,        // tab separated values, tabs, newlines, backslashes escaped
+    JsonLines,  // JSON object per row keyed by header, array if no header
+    Markdown    // GitHub flavored markdown table
+};
+
+namespace detail {
+
+/**
+ * @brief Writes rows of cells in one of machine readable formats. Cells are
+ * escaped into buffer which is written to stream in large chunks, cells
+ * which need no escaping are copied as is.
+ *
+ */
+template <class Ch, class Tr>
+class _TableExporter {
+   public:
+    using string_t = std::basic_string<Ch, Tr>;
+    using string_view_t = std::basic_string_view<Ch, Tr>;
+    using ostream_t = std::basic_ostream<Ch, Tr>;
+
+    static constexpr size_t bufferSize = 1 << 16;
+
+    _TableExporter(ostream_t& os, TableFormat format, Ch delimiter = Ch(','))
+        : _os(os), _format(format), _delimiter(delimiter) {
+        assert(format != TableFormat::Box);
+        _buffer.reserve(bufferSize);
+
+        // characters which make cell escaped or quoted
+        const auto special = [&](std::initializer_list<char> chars) {
+            for (auto ch : chars) _special[static_cast<size_t>(ch)] = true;
+        };
+        switch (format) {
+            case TableFormat::Csv:
+                assert(static_cast<unsigned long>(Tr::to_int_type(delimiter)) <
+                       _special.size());
+                _special[static_cast<size_t>(Tr::to_int_type(delimiter))] =
+                    true;
+                special({'"', '\n', '\r'});
+                break;
+            case TableFormat::Tsv:
+                special({'\t', '\n', '\r', '\\'});
+                break;
+            case TableFormat::JsonLines:
+                std::fill_n(_special.begin(), 0x20, true);
+                special({'"', '\\'});
+                break;
+            case TableFormat::Markdown:
+                special({'|', '\n', '\r', '\\'});
+                break;
+            case TableFormat::Box:
+                break;
+        }
+    }
+
+    _TableExporter(const _TableExporter&) = delete;
+    _TableExporter& operator=(const _TableExporter&) = delete;
+
+    ~_TableExporter() { flush(); }
+
+    template <class Row>
+    void header(const Row& row) {
+        beginHeader();
+        for (auto&& value : row) cell(value);
+        endRow();
+    }
+
+    template <class Row>
+    void row(const Row& row) {
+        beginRow();
+        for (auto&& value : row) cell(value);
+        endRow();
+    }
+
+    // only markdown has place for footer, it becomes the last row
+    template <class Row>
+    void footer(const Row& row) {
+        if (_format == TableFormat::Markdown and not row.empty()) {
+            this->row(row);
+        }
+    }
+
+    void beginHeader() {
+        _header = true;
+        _keys.clear();
+        beginRow();
+    }
+
+    void beginRow() {
+        _column = 0;
+        _rowStart = _buffer.size();
+    }
+
+    void cell(string_view_t value) {
+        if (_header and _format == TableFormat::JsonLines) {
+            // header only names fields of the following rows, keys are
+            // kept escaped
+            const size_t start = _buffer.size();
+            _appendJson(value);
+            _buffer.push_back(Ch(':'));
+            _keys.emplace_back(_buffer, start);
+            _buffer.resize(start);
+            ++_column;
+            return;
+        }
+
+        switch (_format) {
+            case TableFormat::Csv:
+                if (_column) _buffer.push_back(_delimiter);
+                _appendCsv(value);
+                break;
+            case TableFormat::Tsv:
+                if (_column) _buffer.push_back(Ch('\t'));
+                _appendTsv(value);
+                break;
+            case TableFormat::JsonLines:
+                _buffer.push_back(_column ? Ch(',')
+                                  : _keys.empty() ? Ch('[')
+                                                  : Ch('{'));
+                if (_column < _keys.size()) {
+                    _buffer.append(_keys[_column]);
+                } else if (not _keys.empty()) {
+                    _appendJson(_widen(std::to_string(_column)));
+                    _buffer.push_back(Ch(':'));
+                }
+                _appendJson(value);
+                break;
+            case TableFormat::Markdown:
+                if (not _column) _buffer.push_back(Ch('|'));
+                _buffer.push_back(Ch(' '));
+                _appendMarkdown(value);
+                _buffer.append({Ch(' '), Ch('|')});
+                break;
+            case TableFormat::Box:
+                break;
+        }
+        ++_column;
+    }
+
+    void endRow() {
+        const bool header = std::exchange(_header, false);
+        if (_format == TableFormat::JsonLines) {
+            if (header) return;
+            if (not _column) {
+                _buffer.push_back(_keys.empty() ? Ch('[') : Ch('{'));
+            }
+            _buffer.push_back(_keys.empty() ? Ch(']') : Ch('}'));
+        }
+        if (_format == TableFormat::Markdown and not _column) {
+            _buffer.push_back(Ch('|'));
+        }
+        _buffer.push_back(Ch('\n'));
+
+        if (_format == TableFormat::Markdown and not _ruled) {
+            _ruled = true;
+            string_t rule(1, Ch('|'));
+            for (size_t i = 0; i < _column; ++i) {
+                rule.append({Ch('-'), Ch('-'), Ch('-'), Ch('|')});
+            }
+            rule.push_back(Ch('\n'));
+            if (header) {
+                _buffer.append(rule);
+            } else {
+                // markdown table can not go without header, empty one is
+                // put before the first row
+                string_t empty(1, Ch('|'));
+                for (size_t i = 0; i < _column; ++i) {
+                    empty.append({Ch(' '), Ch(' '), Ch('|')});
+                }
+                empty.push_back(Ch('\n'));
+                _buffer.insert(_rowStart, empty + rule);
+            }
+        }
+
+        if (_buffer.size() >= bufferSize) flush();
+    }
+
+    void flush() {
+        if (_buffer.empty()) return;
+        _os.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+        _buffer.clear();
+    }
+
+   private:
+    static bool _isControl(Ch ch) noexcept {
+        return static_cast<unsigned long>(Tr::to_int_type(ch)) < 0x20;
+    }
+
+    // character put after backslash to escape ch, 0 if there is none
+    static Ch _escape(Ch ch) noexcept {
+        switch (ch) {
+            case Ch('"'): return Ch('"');
+            case Ch('\\'): return Ch('\\');
+            case Ch('\n'): return Ch('n');
+            case Ch('\r'): return Ch('r');
+            case Ch('\t'): return Ch('t');
+            default: return Ch();
+        }
+    }
+
+    // position of the first character which needs escaping
+    size_t _find(string_view_t value) const noexcept {
+        for (size_t i = 0; i < value.size(); ++i) {
+            const auto code =
+                static_cast<unsigned long>(Tr::to_int_type(value[i]));
+            if (code < _special.size() and _special[code]) return i;
+        }
+        return string_view_t::npos;
+    }
+
+    static string_t _widen(const std::string& text) {
+        return string_t(text.begin(), text.end());
+    }
+
+    void _appendCsv(string_view_t value) {
+        const auto special = _find(value);
+        if (special == string_view_t::npos) {
+            _buffer.append(value);
+            return;
+        }
+        _buffer.push_back(Ch('"'));
+        for (auto ch : value) {
+            if (ch == Ch('"')) _buffer.push_back(ch);
+            _buffer.push_back(ch);
+        }
+        _buffer.push_back(Ch('"'));
+    }
+
+    void _appendTsv(string_view_t value) {
+        const auto special = _find(value);
+        _buffer.append(value.substr(0, special));
+        if (special == string_view_t::npos) return;
+        for (auto ch : value.substr(special)) {
+            const auto escape = ch == Ch('"') ? Ch() : _escape(ch);
+            if (escape) {
+                _buffer.append({Ch('\\'), escape});
+            } else {
+                _buffer.push_back(ch);
+            }
+        }
+    }
+
+    void _appendJson(string_view_t value) {
+        _buffer.push_back(Ch('"'));
+        const auto special = _find(value);
+        _buffer.append(value.substr(0, special));
+        if (special != string_view_t::npos) {
+            constexpr char hex[] = "0123456789abcdef";
+            for (auto ch : value.substr(special)) {
+                if (const auto escape = _escape(ch)) {
+                    _buffer.append({Ch('\\'), escape});
+                } else if (_isControl(ch)) {
+                    const auto code = Tr::to_int_type(ch);
+                    _buffer.append({Ch('\\'), Ch('u'), Ch('0'), Ch('0'),
+                                    Ch(hex[code >> 4]), Ch(hex[code & 0xF])});
+                } else {
+                    _buffer.push_back(ch);
+                }
+            }
+        }
+        _buffer.push_back(Ch('"'));
+    }
+
+    void _appendMarkdown(string_view_t value) {
+        const auto special = _find(value);
+        _buffer.append(value.substr(0, special));
+        if (special == string_view_t::npos) return;
+        for (auto ch : value.substr(special)) {
+            if (ch == Ch('|') or ch == Ch('\\')) {
+                _buffer.push_back(Ch('\\'));
+                _buffer.push_back(ch);
+            } else if (ch == Ch('\n')) {
+                _buffer.append({Ch('<'), Ch('b'), Ch('r'), Ch('>')});
+            } else if (ch != Ch('\r')) {
+                _buffer.push_back(ch);
+            }
+        }
+    }
+
+    ostream_t& _os;
+    TableFormat _format;
+    Ch _delimiter;
+    std::array<bool, 128> _special{};
+    string_t _buffer;
+    std::vector<string_t> _keys;
+    size_t _column = 0;
+    size_t _rowStart = 0;
+    bool _header = false;
+    bool _ruled = false;
+};
+
+/**
+ * @brief Iterator over rows of table storage or cells of a row, yields
+ * element of view at index
+ *
+ */
+template <class View>
+class _TableIndexIterator {
+   public:
+    using value_type = std::remove_cvref_t<decltype(
+        std::declval<const View&>()[size_t{}])>;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr _TableIndexIterator() = default;
+    constexpr _TableIndexIterator(View view, size_t index)
+        : _view(view), _index(index) {
+    }
+
+    constexpr value_type operator*() const { return _view[_index]; }
+
+    constexpr _TableIndexIterator& operator++() {
+        ++_index;
+        return *this;
+    }
+
+    constexpr _TableIndexIterator operator++(int) {
+        auto copy = *this;
+        ++_index;
+        return copy;
+    }
+
+    constexpr bool operator==(const _TableIndexIterator& other) const {
+        return _index == other._index;
+    }
+
+   private:
+    View _view{};
+    size_t _index = 0;
+};
+
+/**
+ * @brief Cells of table stored column by column. Characters of all cells
+ * live in one arena string, each column keeps offset and size of its
+ * cells, so adding row allocates only when arena or columns grow and
+ * removing rows just shrinks them.
+ *
+ */
+template <class Ch, class Tr>
+class _TableCells {
+   public:
+    using string_t = std::basic_string<Ch, Tr>;
+    using string_view_t = std::basic_string_view<Ch, Tr>;
+
+    /**
+     * @brief Non owning view of single row, valid until cells are changed
+     *
+     */
+    class row_type {
+       public:
+        constexpr row_type() = default;
+        constexpr row_type(const _TableCells* cells, size_t row)
+            : _cells(cells), _row(row) {
+        }
+
+        size_t size() const noexcept { return _cells->columns(); }
+        string_view_t operator[](size_t column) const {
+            return _cells->at(_row, column);
+        }
+
+        auto begin() const { return _TableIndexIterator<row_type>(*this, 0); }
+        auto end() const {
+            return _TableIndexIterator<row_type>(*this, size());
+        }
+
+       private:
+        const _TableCells* _cells = nullptr;
+        size_t _row = 0;
+    };
+
+    size_t size() const noexcept { return _rows; }
+    size_t columns() const noexcept { return _columns.size(); }
+    bool empty() const noexcept { return _rows == 0; }
+
+    string_view_t at(size_t row, size_t column) const {
+        const auto [offset, size] = _columns[column][row];
+        return string_view_t(_arena.data() + offset, size);
+    }
+
+    row_type operator[](size_t row) const { return {this, row}; }
+    row_type front() const { return {this, 0}; }
+    row_type back() const { return {this, _rows - 1}; }
+
+    auto begin() const { return _TableIndexIterator<_Rows>({this}, 0); }
+    auto end() const { return _TableIndexIterator<_Rows>({this}, _rows); }
+
+    /**
+     * @brief Appends cell to current row, write(os) prints it into stream
+     * appending to arena
+     *
+     * @return string_view_t the cell
+     */
+    template <class Fn>
+    string_view_t pushCell(size_t column, Fn&& write) {
+        if (not _stream) _stream.reset(new _Stream(_arena));
+        const size_t offset = _arena.size();
+        write(_stream->os);
+
+        if (column >= _columns.size()) {
+            _columns.resize(column + 1);
+            _columns.back().reserve(std::max(_reserved, _rows + 1));
+        }
+        auto& cells = _columns[column];
+        // column first filled in this row has empty cells above
+        cells.resize(_rows, _Cell{offset, 0});
+        cells.push_back({offset, _arena.size() - offset});
+        return string_view_t(_arena).substr(offset);
+    }
+
+    /**
+     * @brief Completes current row, columns without cell in it get
+     * empty one
+     *
+     */
+    void endRow() {
+        for (auto&& cells : _columns) {
+            cells.resize(_rows + 1, {_arena.size(), 0});
+        }
+        // first row is the best guess of how large the rest will be
+        if (_rows++ == 0 and _reserved > 1) {
+            _arena.reserve(_arena.size() * _reserved);
+        }
+    }
+
+    void popRow() {
+        assert(_rows);
+        --_rows;
+        // cells of a row are appended in column order, so first one
+        // starts where row starts
+        if (not _columns.empty()) _arena.resize(_columns.front()[_rows].offset);
+        for (auto&& cells : _columns) cells.pop_back();
+    }
+
+    /**
+     * @brief Appends rows of other cells after rows of these
+     *
+     */
+    void append(const _TableCells& other) {
+        const size_t base = _arena.size();
+        _arena.append(other._arena);
+        if (_columns.size() < other._columns.size()) {
+            _columns.resize(other._columns.size());
+        }
+
+        for (size_t column = 0; column < _columns.size(); ++column) {
+            auto& cells = _columns[column];
+            cells.resize(_rows, _Cell{base, 0});
+            if (column < other._columns.size()) {
+                for (auto [offset, size] : other._columns[column]) {
+                    cells.push_back({base + offset, size});
+                }
+            }
+            cells.resize(_rows + other._rows, _Cell{_arena.size(), 0});
+        }
+        _rows += other._rows;
+    }
+
+    void clear() {
+        _arena.clear();
+        for (auto&& cells : _columns) cells.clear();
+        _rows = 0;
+    }
+
+    void reserve(size_t rows) {
+        _reserved = rows;
+        for (auto&& cells : _columns) cells.reserve(rows);
+    }
+
+   private:
+    struct _Cell {
+        size_t offset;
+        size_t size;
+    };
+
+    struct _Stream {
+        explicit _Stream(string_t& arena) : buffer(arena), os(&buffer) {}
+
+        _StringAppendBuf<Ch, Tr> buffer;
+        std::basic_ostream<Ch, Tr> os;
+    };
+
+    // stream is bound to arena of its owner, copies create their own
+    struct _StreamHolder : std::unique_ptr<_Stream> {
+        _StreamHolder() = default;
+        _StreamHolder(const _StreamHolder&) noexcept
+            : std::unique_ptr<_Stream>() {
+        }
+        _StreamHolder& operator=(const _StreamHolder&) noexcept {
+            return *this;
+        }
+    };
+
+    struct _Rows {
+        const _TableCells* cells = nullptr;
+        row_type operator[](size_t row) const { return {cells, row}; }
+    };
+
+    string_t _arena;
+    std::vector<std::vector<_Cell>> _columns;
+    size_t _rows = 0;
+    size_t _reserved = 0;
+    _StreamHolder _stream;
+};
+
+}  // namespace detail
+
 template <class Representer = my::DefaultRepresenter,
           class Ch = char,
           class Tr = std::char_traits<Ch>>
@@ -38,8 +557,7 @@ struct Table {
     template <my::representable_with<Representer, ostream_t> Arg,
               my::representable_with<Representer, ostream_t>... Args>
     inline auto& pushRow(Arg&& arg, Args&&... args) {
-        _body.push_back(_receiveRow(std::forward<Arg>(arg),
-                                    std::forward<Args>(args)...));
+        _pushCells(arg, args...);
         return *this;
     }
 
@@ -85,12 +603,13 @@ struct Table {
      * @return auto& chain reference to table object
      */
     inline auto& popRow() {
-        _body.pop_back();
+        _body.popRow();
         return *this;
     }
 
     /**
      * @brief Attempt to preallocate enough memory for specified number of rows.
+     * Cell arena is sized after the first row pushed.
      *
      * @param n number of rows to preallocate
      * @return auto& chain reference to table object
@@ -101,16 +620,93 @@ struct Table {
     }
 
     /**
-     * @brief Retrieve reference to internal std::vector<std::vector<std::string>>
-     * of string rows
+     * @brief Adds row for each element of range, rows are formatted on
+     * several threads and appended in order of range, so table is the same
+     * as if pushRow(table, element) was called for every element in turn.
+     * Range is split into blocks of rows which worker threads take one by
+     * one, each block is formatted into its own table, then cells are
+     * appended to this one and column widths are merged.
+     * @note pushRow is called concurrently, so it and Representer must not
+     * share mutable state. If pushRow throws, rows before the failed
+     * element are kept and exception is rethrown once workers are finished.
      *
-     * @return auto& to data
+     * #Example:
+     * my::Table<> t;
+     * t.pushRows(people, [](auto& table, const Person& person) {
+     *     table.pushRow(person.name, person.friends);
+     * });
+     *
+     * @param rows range of elements
+     * @param pushRow function pushing row of element into given table
+     * @param threads number of worker threads, hardware concurrency if 0
+     * @return auto& chain reference to table object
      */
-    inline auto& data() { return _body; }
+    template <std::ranges::forward_range R, class PushRow>
+    auto& pushRows(const R& rows, PushRow pushRow, size_t threads = 0) {
+        auto it = std::ranges::begin(rows);
+        const auto end = std::ranges::end(rows);
+        if (it == end) return *this;
+        // first row decides number of columns, blocks must agree on it
+        if (_sizes.empty()) pushRow(*this, *it++);
+
+        std::vector<decltype(it)> blocks;
+        for (; it != end; std::ranges::advance(it, _blockRows, end)) {
+            blocks.push_back(it);
+        }
+
+        std::vector<Table> parts(blocks.size());
+        std::vector<std::exception_ptr> errors(blocks.size());
+        std::atomic<size_t> next = 0;
+        std::atomic<bool> failed = false;
+
+        auto work = [&] {
+            for (size_t i; not failed.load(std::memory_order_relaxed) and
+                           (i = next.fetch_add(1)) < blocks.size();) {
+                auto& part = parts[i];
+                part._sizes.assign(_sizes.size(), 0);
+                part.reserve(_blockRows);
+                try {
+                    auto element = blocks[i];
+                    for (size_t n = 0; n < _blockRows and element != end;
+                         ++n, ++element) {
+                        pushRow(part, *element);
+                    }
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        threads = std::clamp<size_t>(threads, 1,
+                                     std::max<size_t>(blocks.size(), 1));
+
+        {
+            // calling thread is one of the workers
+            std::vector<std::jthread> workers;
+            workers.reserve(threads - 1);
+            for (size_t i = 1; i < threads; ++i) workers.emplace_back(work);
+            work();
+        }
+
+        size_t total = _body.size();
+        for (auto&& part : parts) total += part._body.size();
+        _body.reserve(total);
+        for (size_t i = 0; i < parts.size(); ++i) {
+            _body.append(parts[i]._body);
+            for (size_t column = 0; column < _sizes.size(); ++column) {
+                _sizes[column] =
+                    std::max(_sizes[column], parts[i]._sizes[column]);
+            }
+            if (errors[i]) std::rethrow_exception(errors[i]);
+        }
+        return *this;
+    }
 
     /**
-     * @brief Retrieve const reference to internal std::vector<std::vector<std::string>>
-     * of string rows
+     * @brief Retrieve const reference to internal cell storage, range of
+     * rows, each row is range of string views to its cells
      *
      * @return auto& to data
      */
@@ -127,12 +723,10 @@ struct Table {
     }
 
     /**
-     * @brief Range access
+     * @brief Range access, rows are views valid until table is changed
      *
      * @return respective iterator
      */
-    inline auto begin() { return _body.begin(); }
-    inline auto end() { return _body.end(); }
     inline auto begin() const { return _body.begin(); }
     inline auto end() const { return _body.end(); }
 
@@ -209,6 +803,48 @@ struct Table {
         _printFooterHTML(os);
     }
 
+    /**
+     * @brief Prints header and rows as comma separated values, cells with
+     * delimiter, quotes or line breaks are quoted
+     *
+     * @param os ostream reference
+     * @param delimiter character separating cells
+     */
+    inline void printCSV(ostream_t& os, Ch delimiter = Ch(',')) const {
+        _export(os, my::TableFormat::Csv, delimiter);
+    }
+
+    /**
+     * @brief Prints header and rows as tab separated values, tabs, line
+     * breaks and backslashes in cells are escaped as \t, \n, \r, \\
+     *
+     * @param os ostream reference
+     */
+    inline void printTSV(ostream_t& os) const {
+        _export(os, my::TableFormat::Tsv);
+    }
+
+    /**
+     * @brief Prints each row as JSON object on its own line, keys are taken
+     * from header, rows of table without header are printed as arrays.
+     * Cells are always JSON strings.
+     *
+     * @param os ostream reference
+     */
+    inline void printJSONLines(ostream_t& os) const {
+        _export(os, my::TableFormat::JsonLines);
+    }
+
+    /**
+     * @brief Prints table as GitHub flavored markdown table, footer is
+     * printed as the last row
+     *
+     * @param os ostream reference
+     */
+    inline void printMarkdown(ostream_t& os) const {
+        _export(os, my::TableFormat::Markdown);
+    }
+
     /**
      * @brief Prints table into std::cout. You can also use operator<<
      *
@@ -317,8 +953,9 @@ struct Table {
         os << "</table>";
     }
 
+    template <class Row>
     auto _printRowHelperHTML(ostream_t& os, const Ch* tag,
-                             const std::vector<string_t>& row) const {
+                             const Row& row) const {
         os << "<tr>";
         for (auto&& el : row) {
             os << "<" << tag << ">" << el << "</" << tag << ">";
@@ -326,10 +963,18 @@ struct Table {
         os << "</tr>";
     }
 
+    void _export(ostream_t& os, my::TableFormat format,
+                 Ch delimiter = Ch(',')) const {
+        detail::_TableExporter<Ch, Tr> out(os, format, delimiter);
+        if (not _header.empty()) out.header(_header);
+        for (auto&& row : _body) out.row(row);
+        out.footer(_footer);
+    }
+
     // helpers
 
-    inline auto
-    _printRowHelper(ostream_t& os, const std::vector<string_t>& row) const {
+    template <class Row>
+    inline auto _printRowHelper(ostream_t& os, const Row& row) const {
         const auto dash = my::styles[static_cast<size_t>(_style)][1];  // │
         auto row_iter = row.begin();
         auto size_iter = _sizes.begin();
@@ -337,7 +982,7 @@ struct Table {
         auto size_end = _sizes.end();
         for (; row_iter != row_end and size_iter != size_end;
              ++row_iter, ++size_iter) {
-            const auto element_size = row_iter->size();
+            const auto element_size = my::displayWidth(*row_iter);
             const auto size = *size_iter;
 
             os << dash << ' ' << *row_iter << ' ';
@@ -373,6 +1018,40 @@ struct Table {
         os << right_corner << '\n';
     }
 
+    // represents cells straight into arena of the body
+    template <class Arg, class... Args>
+    void _pushCells(const Arg& arg, const Args&... args) {
+        // first row pushed without header decides number of columns
+        const bool fixed = not _sizes.empty();
+        size_t column = 0;
+
+        const auto cell = [&](const auto& value) {
+            if (fixed and column >= _sizes.size()) return;
+            const auto text = _body.pushCell(column, [&](ostream_t& os) {
+                // every cell starts with default formatting, as in fresh
+                // stream, failbit left by previous cell cleared too
+                os.clear();
+                os.flags(std::ios_base::skipws | std::ios_base::dec);
+                os.width(0);
+                os.precision(6);
+                os.fill(os.widen(' '));
+                _represent(os, value);
+            });
+            if (column >= _sizes.size()) _sizes.resize(column + 1);
+            _sizes[column] = std::max(_sizes[column], my::displayWidth(text));
+            ++column;
+        };
+
+        if constexpr (sizeof...(args) == 0 and std::ranges::range<Arg>) {
+            for (auto&& value : arg) cell(value);
+        } else {
+            cell(arg);
+            (cell(args), ...);
+        }
+        assert(column);
+        _body.endRow();
+    }
+
     template <std::input_iterator It>
     auto _readRow(It begin, It end) {
         const size_t size = std::ranges::distance(begin, end);
@@ -388,7 +1067,7 @@ struct Table {
              begin != end and size_iter != size_end;
              ++begin, ++size_iter) {
             const auto value = _represent.template get<Ch, Tr>(*begin);
-            const size_t value_size = value.size();
+            const size_t value_size = my::displayWidth(value);
 
             if (value_size > *size_iter) {
                 *size_iter = value_size;
@@ -406,7 +1085,7 @@ struct Table {
     auto _readVariadicRowImpl(std::vector<string_t>& row, It size_iter,
                               Arg&& arg, Args&&... args) {
         const auto value = _represent.template get<Ch, Tr>(arg);
-        const size_t value_size = value.size();
+        const size_t value_size = my::displayWidth(value);
 
         if (value_size > *size_iter) {
             *size_iter = value_size;
@@ -458,7 +1137,7 @@ struct Table {
     }
 
     std::vector<string_t> _header;
-    std::vector<std::vector<string_t>> _body;
+    detail::_TableCells<Ch, Tr> _body;
     std::vector<string_t> _footer;
     std::vector<size_t> _sizes;
     //
@@ -467,10 +1146,367 @@ struct Table {
     bool _separate_each = false;
     size_t _footer_after_lines = 0;
     const uint16_t _pad = 2;
+    static constexpr size_t _blockRows = 1024;
+
+    Representer _represent;
+};
+
+/**
+ * @brief Table printed row by row as rows are pushed, with constant memory
+ * use. Cells are represented into single reused buffer and every line is
+ * written into the stream at once, nothing is kept after it is printed.
+ * Column widths are either declared up front or taken from the first
+ * sample rows, which are held until sample is full (or finish() is
+ * called), then printed and streaming starts.
+ *
+ * #Example:
+ * my::TableStream<> table(std::cout, {8, 12});  // declared widths
+ * table.header("id", "latency");
+ * for (auto&& m : metrics) table.pushRow(m.id, m.latency);
+ * table.finish();  // or let destructor close the table
+ *
+ * @note cells wider than their column are printed in full, so they shift
+ * the rest of their row. Rows must have the same number of cells as the
+ * first one.
+ *
+ * @tparam Representer representer used to print each cell
+ * @tparam Ch char type
+ * @tparam Tr char traits type
+ */
+template <class Representer = my::DefaultRepresenter,
+          class Ch = char,
+          class Tr = std::char_traits<Ch>>
+class TableStream {
+   public:
+    using string_t = std::basic_string<Ch, Tr>;
+    using ostream_t = std::basic_ostream<Ch, Tr>;
+
+    static constexpr size_t defaultSampleRows = 100;
+
+    /**
+     * @brief Creates table which takes column widths from the widest cells
+     * of first sampleRows rows, header included
+     *
+     * @param os stream to print to, must outlive the table
+     * @param sampleRows amount of rows held to measure columns
+     */
+    explicit TableStream(ostream_t& os, size_t sampleRows = defaultSampleRows)
+        : _os(os), _sampleRows(std::max<size_t>(sampleRows, 1)) {
+    }
+
+    /**
+     * @brief Creates table with declared column widths, rows are printed
+     * right away
+     *
+     * @param os stream to print to, must outlive the table
+     * @param widths width of each column
+     */
+    TableStream(ostream_t& os, std::vector<size_t> widths)
+        : _os(os), _sizes(std::move(widths)), _sampleRows(0) {
+        assert(not _sizes.empty());
+    }
+
+    TableStream(const TableStream&) = delete;
+    TableStream& operator=(const TableStream&) = delete;
+
+    ~TableStream() { finish(); }
+
+    /**
+     * @brief Sets header for columns, must be called before first row.
+     * Works exactly the same way as pushRow() does.
+     *
+     * @return auto& chain reference to table object
+     */
+    template <my::representable_with<Representer, ostream_t> Arg,
+              my::representable_with<Representer, ostream_t>... Args>
+    auto& header(Arg&& arg, Args&&... args) {
+        assert(_rows == 0 and _sample.empty() and not _started);
+        if (_exporter) {
+            _exporter->beginHeader();
+            _forEachCell([&](size_t, const string_t& cell) {
+                _exporter->cell(cell);
+            }, arg, args...);
+            _exporter->endRow();
+            return *this;
+        }
+        _header.clear();
+        _forEachCell([&](size_t, const string_t& cell) {
+            _header.push_back(cell);
+        }, arg, args...);
+        _measure(_header);
+        if (_streaming()) _start();
+        return *this;
+    }
+
+    /**
+     * @brief Sets footer printed by finish(). Works exactly the same
+     * way as pushRow() does.
+     *
+     * @return auto& chain reference to table object
+     */
+    template <my::representable_with<Representer, ostream_t> Arg,
+              my::representable_with<Representer, ostream_t>... Args>
+    auto& footer(Arg&& arg, Args&&... args) {
+        _footer.clear();
+        _forEachCell([&](size_t, const string_t& cell) {
+            _footer.push_back(cell);
+        }, arg, args...);
+        if (not _streaming()) _measure(_footer);
+        return *this;
+    }
+
+    /**
+     * @brief Prints row, or holds it while columns are being sampled.
+     * If there is only one parameter and it is iterable elements will be
+     * read one by one, otherwise each parameter is single cell.
+     *
+     * @return auto& chain reference to table object
+     */
+    template <my::representable_with<Representer, ostream_t> Arg,
+              my::representable_with<Representer, ostream_t>... Args>
+    auto& pushRow(Arg&& arg, Args&&... args) {
+        if (_exporter) {
+            _exporter->beginRow();
+            _forEachCell([&](size_t, const string_t& cell) {
+                _exporter->cell(cell);
+            }, arg, args...);
+            _exporter->endRow();
+            ++_rows;
+            return *this;
+        }
+        if (_streaming()) {
+            if (not _started) _start();
+            if (_rows and _separate_each) _printSeparator(5, 6, 7);
+            _beginLine();
+            _forEachCell([&](size_t column, const string_t& cell) {
+                _appendCell(column, cell);
+            }, arg, args...);
+            _endLine();
+            ++_rows;
+            return *this;
+        }
+
+        auto& row = _sample.emplace_back();
+        _forEachCell([&](size_t, const string_t& cell) {
+            row.push_back(cell);
+        }, arg, args...);
+        _measure(row);
+        if (_sample.size() >= _sampleRows) _flushSample();
+        return *this;
+    }
+
+    /**
+     * @brief Prints rows held for sampling, footer and bottom border.
+     * Called by destructor, does nothing on subsequent calls.
+     *
+     */
+    void finish() {
+        if (_finished) return;
+        if (_exporter) {
+            _exporter->footer(_footer);
+            _exporter->flush();
+            _os.flush();
+            _finished = true;
+            return;
+        }
+        if (not _streaming()) _flushSample();
+        if (_sizes.empty()) {
+            _finished = true;
+            return;
+        }
+        if (not _started) _start();
+        if (not _footer.empty()) {
+            _printSeparator(5, 6, 7);
+            _printRow(_footer);
+        }
+        _printSeparator(8, 9, 10);
+        _os.flush();
+        _finished = true;
+    }
+
+    /**
+     * @brief Sets output format, must be called before header and rows.
+     * Rows of machine readable formats are written as soon as they are
+     * pushed, without sampling widths.
+     *
+     * #Example:
+     * my::TableStream<> csv(file);
+     * csv.format(my::TableFormat::Csv).header("id", "latency");
+     *
+     * @param format my::TableFormat enum value
+     * @param delimiter character separating cells of Csv
+     * @return auto& chain reference to table object
+     */
+    auto& format(my::TableFormat format, Ch delimiter = Ch(',')) {
+        assert(size() == 0 and _header.empty() and not _started);
+        _exporter.reset();
+        if (format != my::TableFormat::Box) {
+            _exporter = std::make_unique<detail::_TableExporter<Ch, Tr>>(
+                _os, format, delimiter);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Sets style of table, must be called before first line is
+     * printed
+     *
+     * @param style my::Style enum value
+     * @return auto& chain reference to table object
+     */
+    auto& style(my::Style style) {
+        _style = style;
+        return *this;
+    }
+
+    /**
+     * @brief Sets weather to print separator after each row.
+     * Call one more time to switch
+     *
+     * @return auto& chain reference to table object
+     */
+    auto& separateEach() {
+        _separate_each = not _separate_each;
+        return *this;
+    }
+
+    /**
+     * @return Number of rows printed or held so far
+     */
+    size_t size() const noexcept { return _rows + _sample.size(); }
+
+    /**
+     * @return Widths of columns, empty until they are known
+     */
+    const std::vector<size_t>& widths() const noexcept { return _sizes; }
+
+   private:
+    bool _streaming() const noexcept { return _sampleRows == 0; }
+
+    // represents every cell into reused buffer and calls fn(column, cell)
+    template <class Fn, class Arg, class... Args>
+    void _forEachCell(Fn&& fn, const Arg& arg, const Args&... args) {
+        size_t column = 0;
+        const auto cell = [&](const auto& value) {
+            _cell.clear();
+            // every cell starts with default formatting, as in fresh stream,
+            // failbit left by previous cell cleared too
+            _cellStream.clear();
+            _cellStream.flags(std::ios_base::skipws | std::ios_base::dec);
+            _cellStream.width(0);
+            _cellStream.precision(6);
+            _cellStream.fill(_cellStream.widen(' '));
+            _represent(_cellStream, value);
+            fn(column++, _cell);
+        };
+
+        if constexpr (sizeof...(args) == 0 and std::ranges::range<Arg>) {
+            for (auto&& value : arg) cell(value);
+        } else {
+            cell(arg);
+            (cell(args), ...);
+        }
+        assert(_sizes.empty() or column == _sizes.size());
+    }
+
+    void _measure(const std::vector<string_t>& row) {
+        if (_sizes.empty()) _sizes.resize(row.size());
+        for (size_t i = 0; i < row.size() and i < _sizes.size(); ++i) {
+            _sizes[i] = std::max(_sizes[i], my::displayWidth(row[i]));
+        }
+    }
+
+    void _flushSample() {
+        _sampleRows = 0;
+        if (_sizes.empty()) return;
+        _start();
+        for (auto&& row : _sample) {
+            if (_rows and _separate_each) _printSeparator(5, 6, 7);
+            _printRow(row);
+            ++_rows;
+        }
+        _sample.clear();
+        _sample.shrink_to_fit();
+    }
+
+    void _start() {
+        _started = true;
+        _printSeparator(2, 3, 4);
+        if (_header.empty()) return;
+        _printRow(_header);
+        _printSeparator(5, 6, 7);
+    }
+
+    void _printRow(const std::vector<string_t>& row) {
+        _beginLine();
+        for (size_t i = 0; i < row.size(); ++i) _appendCell(i, row[i]);
+        _endLine();
+    }
+
+    void _beginLine() { _line.clear(); }
+
+    void _appendCell(size_t column, const string_t& cell) {
+        _appendSymbol(1);  // │
+        _line.push_back(Ch(' '));
+        _line.append(cell);
+        const size_t width = column < _sizes.size() ? _sizes[column] : 0;
+        const size_t cell_width = my::displayWidth(cell);
+        _line.append(width > cell_width ? width - cell_width + 1 : 1, Ch(' '));
+    }
+
+    void _endLine() {
+        _appendSymbol(1);  // │
+        _line.push_back(Ch('\n'));
+        _os.write(_line.data(), static_cast<std::streamsize>(_line.size()));
+    }
+
+    void _printSeparator(size_t left, size_t middle, size_t right) {
+        _beginLine();
+        for (size_t i = 0; i < _sizes.size(); ++i) {
+            _appendSymbol(i == 0 ? left : middle);
+            for (size_t j = 0; j < _sizes[i] + _pad; ++j) _appendSymbol(0);
+        }
+        _appendSymbol(right);
+        _line.push_back(Ch('\n'));
+        _os.write(_line.data(), static_cast<std::streamsize>(_line.size()));
+    }
+
+    void _appendSymbol(size_t index) {
+        const char* symbol = my::styles[static_cast<size_t>(_style)][index];
+        for (; *symbol; ++symbol) _line.push_back(Ch(*symbol));
+    }
+
+    ostream_t& _os;
+    std::vector<size_t> _sizes;
+    size_t _sampleRows;
+    std::vector<string_t> _header;
+    std::vector<string_t> _footer;
+    std::vector<std::vector<string_t>> _sample;
+    std::unique_ptr<detail::_TableExporter<Ch, Tr>> _exporter;
+    //
+    string_t _cell;
+    detail::_StringAppendBuf<Ch, Tr> _cellBuffer{_cell};
+    ostream_t _cellStream{&_cellBuffer};
+    string_t _line;
+    //
+    my::Style _style = my::Style::Curvy;
+    bool _separate_each = false;
+    bool _started = false;
+    bool _finished = false;
+    size_t _rows = 0;
+    static constexpr uint16_t _pad = 2;
 
     Representer _represent;
 };
 
+/**
+ * @brief Tag requesting my::table() to format rows on several threads
+ *
+ */
+struct Parallel {
+    size_t threads = 0;  // hardware concurrency if 0
+};
+
 namespace detail {
 
 template <std::ranges::range T>
@@ -509,6 +1545,41 @@ auto _tableObjects(const T& objects, Projections... proj) {
     return t;
 }
 
+template <std::ranges::forward_range T>
+auto _tableIterable(Parallel parallel, const T& iterable) {
+    Table t;
+    t.pushRows(
+        iterable,
+        [](auto& table, const auto& el) { table.pushRow(el); },
+        parallel.threads);
+    return t;
+}
+
+template <std::ranges::forward_range T>
+auto _tableMap(Parallel parallel, const T& map) {
+    Table t;
+    t.pushRows(
+        map,
+        [](auto& table, const auto& el) {
+            table.pushRow(el.first, el.second);
+        },
+        parallel.threads);
+    return t;
+}
+
+template <std::ranges::forward_range T, class... Projections>
+auto _tableObjects(Parallel parallel, const T& objects,
+                   Projections... proj) {
+    Table t;
+    t.pushRows(
+        objects,
+        [&](auto& table, const auto& el) {
+            table.pushRow(std::invoke(proj, el)...);
+        },
+        parallel.threads);
+    return t;
+}
+
 }  // namespace detail
 
 /**
@@ -549,4 +1620,42 @@ constexpr auto table(const T& val, Projections... proj) {
     return detail::_tableObjects(val, std::move(proj)...);
 }
 
+/**
+ * @brief Creates the same table as my::table(val) does, formatting rows
+ * on several threads, see Table::pushRows()
+ *
+ * #Example:
+ * std::cout << my::table(my::Parallel{}, matrix);
+ *
+ * @param parallel number of threads to use
+ * @param val value to represent as table
+ * @return printable Table object
+ */
+template <std::ranges::forward_range T>
+auto table(Parallel parallel, const T& val) {
+    if constexpr (my::pair_like<std::ranges::range_value_t<T>>) {
+        return detail::_tableMap(parallel, val);
+    } else {
+        return detail::_tableIterable(parallel, val);
+    }
+}
+
+/**
+ * @brief Creates the same table as my::table(val, proj...) does,
+ * formatting rows on several threads, see Table::pushRows()
+ *
+ * #Example:
+ * auto t = my::table(my::Parallel{.threads = 4}, people,
+ *                    &Person::name, &Person::friends);
+ *
+ * @param parallel number of threads to use
+ * @param val range of objects
+ * @param proj functions to project each value
+ * @return printable Table object
+ */
+template <std::ranges::forward_range T, class... Projections>
+auto table(Parallel parallel, const T& val, Projections... proj) {
+    return detail::_tableObjects(parallel, val, std::move(proj)...);
+}
+
 }  // namespace my
\ No newline at end of file
@@ -1,54 +1,318 @@
+#pragma once
+#ifndef MY_ZIP_OSTREAM_HPP
+#define MY_ZIP_OSTREAM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <concepts>
+#include <condition_variable>
 #include <functional>
 #include <iostream>
-#include <my/format/println.hpp>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <io.h>
+#define MY_ZIP_OSTREAM_WIN32 1
+#else
+#include <unistd.h>
+#endif
 
-// TODO refactor this file!!
-// this may help: https://stackoverflow.com/questions/1760726/how-can-i-compose-output-streams-so-output-goes-multiple-places-at-once
 namespace my {
 
 /**
- * @brief Simple utility class. Provide possibility to print into multiple
- * streams in one operator<< call
+ * @brief How zip stream delivers output to a sink
+ *
+ */
+enum class ZipFlush {
+    Sync,  // written and flushed on the thread of the zip stream
+    Async  // queued and written by sink's own background thread
+};
+
+namespace detail {
+
+/**
+ * @brief Destination of zip stream, writes and flushes are plain callbacks
+ * so streams and file descriptors are handled the same way
+ *
+ */
+template <class Ch>
+struct _zip_sink {
+    std::function<bool(const Ch*, std::streamsize)> write;
+    std::function<bool()> flush;
+};
+
+inline bool _writeFd(int fd, const char* data, std::streamsize size) {
+    while (size > 0) {
+#if defined(MY_ZIP_OSTREAM_WIN32)
+        const auto written = ::_write(fd, data, static_cast<unsigned>(size));
+#else
+        const auto written = ::write(fd, data, static_cast<size_t>(size));
+#endif
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+/**
+ * @brief Sink wrapper which writes on its own thread. Bytes are appended
+ * to pending buffer under the lock, writer thread swaps it with the
+ * buffer it writes from, so zip stream never waits for slow destination.
+ *
+ */
+template <class Ch>
+class _ZipAsyncSink {
+   public:
+    explicit _ZipAsyncSink(_zip_sink<Ch> sink)
+        : _sink(std::move(sink)),
+          _thread([this](std::stop_token stop) { _run(stop); }) {
+    }
+
+    ~_ZipAsyncSink() {
+        {
+            std::lock_guard lock(_mutex);
+            _thread.request_stop();
+        }
+        _wake.notify_one();
+    }
+
+    bool write(const Ch* data, std::streamsize size) {
+        {
+            std::lock_guard lock(_mutex);
+            _pending.append(data, static_cast<size_t>(size));
+        }
+        _wake.notify_one();
+        return not _failed.load(std::memory_order_relaxed);
+    }
+
+    // requests flush of the destination, does not wait for it
+    bool flush() {
+        {
+            std::lock_guard lock(_mutex);
+            _flush = true;
+        }
+        _wake.notify_one();
+        return not _failed.load(std::memory_order_relaxed);
+    }
+
+   private:
+    void _run(std::stop_token stop) {
+        std::basic_string<Ch> writing;
+        for (;;) {
+            bool flush;
+            {
+                std::unique_lock lock(_mutex);
+                _wake.wait(lock, [&] {
+                    return stop.stop_requested() or _flush or
+                           not _pending.empty();
+                });
+                if (stop.stop_requested() and _pending.empty()) break;
+                writing.swap(_pending);
+                flush = std::exchange(_flush, false);
+            }
+
+            bool ok = _sink.write(
+                writing.data(), static_cast<std::streamsize>(writing.size()));
+            if (flush) ok = _sink.flush() and ok;
+            if (not ok) _failed.store(true, std::memory_order_relaxed);
+            writing.clear();
+        }
+        if (not _sink.flush()) _failed.store(true, std::memory_order_relaxed);
+    }
+
+    _zip_sink<Ch> _sink;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::basic_string<Ch> _pending;
+    bool _flush = false;
+    std::atomic<bool> _failed{false};
+    std::jthread _thread;
+};
+
+/**
+ * @brief Stream buffer collecting formatted output and handing the same
+ * bytes to every sink once buffer is full or stream is flushed
+ *
+ */
+template <class Ch, class Tr>
+class _ZipBuf : public std::basic_streambuf<Ch, Tr> {
+   public:
+    using traits_type = Tr;
+    using int_type = typename traits_type::int_type;
+
+    explicit _ZipBuf(size_t size)
+        : _buffer(std::max<size_t>(size, 1)) {
+        this->setp(_buffer.data(), _buffer.data() + _buffer.size());
+    }
+
+    void add(_zip_sink<Ch> sink, ZipFlush mode) {
+        _drain();
+        if (mode == ZipFlush::Async) {
+            auto async = std::make_shared<_ZipAsyncSink<Ch>>(std::move(sink));
+            sink = {[async](const Ch* data, std::streamsize size) {
+                        return async->write(data, size);
+                    },
+                    [async] { return async->flush(); }};
+        }
+        _sinks.push_back(std::move(sink));
+    }
+
+    size_t size() const noexcept { return _sinks.size(); }
+
+   protected:
+    int_type overflow(int_type ch) override {
+        if (not _drain()) return traits_type::eof();
+        if (traits_type::eq_int_type(ch, traits_type::eof())) {
+            return traits_type::not_eof(ch);
+        }
+        *this->pptr() = traits_type::to_char_type(ch);
+        this->pbump(1);
+        return ch;
+    }
+
+    std::streamsize xsputn(const Ch* data, std::streamsize size) override {
+        // chunks larger than the buffer go to sinks without copying
+        if (size >= static_cast<std::streamsize>(_buffer.size())) {
+            if (not _drain() or not _write(data, size)) return 0;
+            return size;
+        }
+        return std::basic_streambuf<Ch, Tr>::xsputn(data, size);
+    }
+
+    int sync() override {
+        bool ok = _drain();
+        for (auto&& sink : _sinks) ok = sink.flush() and ok;
+        return ok ? 0 : -1;
+    }
+
+   private:
+    bool _drain() {
+        const auto size = this->pptr() - this->pbase();
+        this->setp(_buffer.data(), _buffer.data() + _buffer.size());
+        return size == 0 or _write(_buffer.data(), size);
+    }
+
+    bool _write(const Ch* data, std::streamsize size) {
+        bool ok = true;
+        for (auto&& sink : _sinks) ok = sink.write(data, size) and ok;
+        return ok;
+    }
+
+    std::vector<Ch> _buffer;
+    std::vector<_zip_sink<Ch>> _sinks;
+};
+
+}  // namespace detail
+
+/**
+ * @brief Output stream duplicating everything written to it into several
+ * streams and file descriptors. Object is formatted once into internal
+ * buffer, then the same characters are written to every sink when buffer
+ * fills up or the stream is flushed (std::flush, std::endl or
+ * destruction), so tee to console and file costs one formatting.
+ * Slow sinks can be attached with ZipFlush::Async to be written on their
+ * own thread.
+ *
+ * #Example:
+ * std::ofstream file("test.txt");
+ * my::zip_ostream os(std::cout, file);
+ * os.attach(STDERR_FILENO, my::ZipFlush::Async);
+ * os << "Hello World!" << std::endl; // outputs message to all three
  *
- * Example:
- *     std::fstream fs("test.txt", std::ios::out);
- *     my::zip_ostream os(std::cout, fs);
- *     os << "Hello World!"; // outputs message both to fstream and cout
+ * @note attached streams must outlive zip stream, output of sinks gets
+ * delayed until flush, use std::unitbuf for interactive output
  *
  * @tparam Ch char type
  * @tparam Tr char traits type
  */
-template <class Ch, class Tr>
-class basic_zip_ostream {
+template <class Ch, class Tr = std::char_traits<Ch>>
+class basic_zip_ostream : public std::basic_ostream<Ch, Tr> {
    public:
     using stream_type = std::basic_ostream<Ch, Tr>;
 
-    template <class... Args>
-    explicit basic_zip_ostream(Args&... streams) {
-        _streams.reserve(sizeof...(streams));
-        (_streams.emplace_back(streams), ...);
+    static constexpr size_t defaultBufferSize = 8192;
+
+    /**
+     * @brief Constructs zip stream writing synchronously to all streams
+     *
+     * @param streams streams to duplicate output into
+     */
+    template <std::derived_from<stream_type>... Streams>
+    explicit basic_zip_ostream(Streams&... streams)
+        : stream_type(nullptr), _buffer(defaultBufferSize) {
+        this->init(&_buffer);
+        (attach(streams), ...);
     }
 
+    basic_zip_ostream(const basic_zip_ostream&) = delete;
+    basic_zip_ostream& operator=(const basic_zip_ostream&) = delete;
+
     /**
-     * @brief view raw vector of my::printer_base instances
+     * @brief Flushes buffered output to all sinks and waits for async
+     * ones to finish writing
      *
      */
-    constexpr auto& data() { return _streams; }
-    constexpr const auto& data() const { return _streams; }
+    ~basic_zip_ostream() { _buffer.pubsync(); }
 
-    friend auto& operator<<(basic_zip_ostream& os, const auto& obj) {
-        for (auto&& stream : os._streams) {
-            stream.get() << obj;
-        }
-        return os;
+    /**
+     * @brief Adds stream as sink, output buffered so far goes to already
+     * attached sinks only
+     *
+     * @param os stream which must outlive zip stream
+     * @param mode whether stream is written on this or its own thread
+     * @return basic_zip_ostream& *this
+     */
+    basic_zip_ostream& attach(stream_type& os,
+                              ZipFlush mode = ZipFlush::Sync) {
+        _buffer.add({[&os](const Ch* data, std::streamsize size) {
+                         return bool(os.write(data, size));
+                     },
+                     [&os] { return bool(os.flush()); }},
+                    mode);
+        return *this;
+    }
+
+    /**
+     * @brief Adds file descriptor as sink, it is not closed by zip stream
+     *
+     * @param fd open file descriptor
+     * @param mode whether fd is written on this or its own thread
+     * @return basic_zip_ostream& *this
+     */
+    basic_zip_ostream& attach(int fd, ZipFlush mode = ZipFlush::Sync)
+        requires std::same_as<Ch, char>
+    {
+        _buffer.add({[fd](const char* data, std::streamsize size) {
+                         return detail::_writeFd(fd, data, size);
+                     },
+                     [] { return true; }},
+                    mode);
+        return *this;
     }
 
+    /**
+     * @return Number of attached sinks
+     */
+    size_t size() const noexcept { return _buffer.size(); }
+
    private:
-    std::vector<my::printer_base<Ch, Tr>> _streams;
+    detail::_ZipBuf<Ch, Tr> _buffer;
 };
 
-using zip_ostream = basic_zip_ostream<char, std::char_traits<char>>;
-using zip_wostream = basic_zip_ostream<wchar_t, std::char_traits<wchar_t>>;
+using zip_ostream = basic_zip_ostream<char>;
+using zip_wostream = basic_zip_ostream<wchar_t>;
+
+}  // namespace my
 
-}  // namespace my
\ No newline at end of file
+#endif  // MY_ZIP_OSTREAM_HPP
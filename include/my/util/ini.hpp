@@ -1,14 +1,32 @@
 #pragma once
 
 #include <my/format/format.hpp>
+#include <my/util/mapped_file.hpp>
+#include <my/util/structures/FlatMap.hpp>
 //
-#include <bitset>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <cassert>
+#include <charconv>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <fstream>
 #include <limits>
 #include <map>
+#include <optional>
+#include <random>
 #include <ranges>
+#include <span>
 #include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
 #include <variant>
+#include <vector>
 
 namespace my {
 
@@ -25,50 +43,1191 @@ template <class... Ts>
 overload(Ts...) -> overload<Ts...>;
 
 /**
- * @brief Manipulator to print floats without zeroes at the end
+ * @brief Appends shortest representation of float which is read back to the
+ * same value, dot is always present so it is never mistaken for integer
  *
- * @tparam T floating point
+ * @param out buffer to append to
+ * @param value floating point
  */
 template <std::floating_point T>
-struct stripZeroes {
-    constexpr explicit stripZeroes(T value)
-        : _value(value) {
+void _appendFloatingPoint(std::string& out, T value) {
+    std::array<char, 64> buffer;
+    auto [end, ec] = std::to_chars(buffer.data(),
+                                   buffer.data() + buffer.size(), value);
+    assert(ec == std::errc{});
+
+    const std::string_view digits(buffer.data(), end);
+    const auto exponent = digits.find('e');
+    const auto mantissa = digits.substr(0, exponent);
+
+    if (mantissa.find_first_not_of("+-0123456789") != mantissa.npos) {
+        out.append(digits);  // already has dot, or is inf/nan
+        return;
     }
 
-    template <class Ch, class Tr>
-    friend auto& operator<<(std::basic_ostream<Ch, Tr>& os,
-                            const stripZeroes& obj) {
-        std::basic_stringstream<Ch, Tr> ss;
+    out.append(mantissa);
+    out.append(".0");
+    if (exponent != digits.npos) out.append(digits.substr(exponent));
+}
+
+/**
+ * @brief Appends string in quotes, escaping inner quotes with backslash
+ * the way my::Ini reads them
+ *
+ * @param out buffer to append to
+ * @param value string to quote
+ */
+inline void _appendQuoted(std::string& out, std::string_view value) {
+    out.push_back('"');
+    for (size_t pos = 0;;) {
+        const auto quote = value.find('"', pos);
+        out.append(value.substr(pos, quote - pos));
+        if (quote == value.npos) break;
+        out.append("\\\"");
+        pos = quote + 1;
+    }
+    out.push_back('"');
+}
+
+/**
+ * @brief Invokes parse with digits of numeric token without ' and _
+ * separators. Token is passed as-is when it has no separators, otherwise
+ * digits are copied into small stack buffer (heap only for absurdly
+ * long tokens)
+ *
+ * @param token numeric token as it appears in the source
+ * @param parse function accepting std::string_view of digits
+ * @return result of parse
+ */
+template <class Parse>
+constexpr auto _withoutSeparators(std::string_view token, Parse parse) {
+    constexpr auto isSeparator = [](char ch) {
+        return ch == '\'' or ch == '_';
+    };
+
+    const auto separator = std::ranges::find_if(token, isSeparator);
+    if (separator == token.end()) return parse(token);
+
+    auto strip = [&](char* out) {
+        const char* begin = out;
+        for (auto ch : token) {
+            if (not isSeparator(ch)) *out++ = ch;
+        }
+        return std::string_view(begin, out);
+    };
+
+    if (token.size() <= 64) {
+        std::array<char, 64> buffer;
+        return parse(strip(buffer.data()));
+    }
+
+    std::string buffer(token.size(), '\0');
+    return parse(strip(buffer.data()));
+}
+
+/**
+ * @brief Decodes integer token with std::from_chars, digit separators
+ * are skipped. Decimal tokens may have leading sign. Binary, octal and
+ * hexadecimal tokens are read as unsigned bit pattern, thus whole range
+ * of Int is covered (e.g. 0xFFFFFFFFFFFFFFFF is -1 for int64_t)
+ *
+ * @tparam Int signed integral type
+ * @param token digits as they appear in the source (without radix prefix)
+ * @param base one of 2, 8, 10, 16
+ * @return parsed value or std::nullopt if token is invalid or out of range
+ */
+template <std::signed_integral Int>
+std::optional<Int> _parseInteger(std::string_view token, int base = 10) {
+    return _withoutSeparators(token, [base](std::string_view digits)
+                                         -> std::optional<Int> {
+        if (base == 10 and digits.starts_with('+')) {
+            digits.remove_prefix(1);
+            if (digits.starts_with('-')) return std::nullopt;
+        }
+
+        const char* const first = digits.data();
+        const char* const last = first + digits.size();
+
+        if (base == 10) {
+            Int result{};
+            const auto [ptr, ec] = std::from_chars(first, last, result);
+            if (ec != std::errc{} or ptr != last) return std::nullopt;
+            return result;
+        }
+
+        std::make_unsigned_t<Int> result{};
+        const auto [ptr, ec] = std::from_chars(first, last, result, base);
+        if (ec != std::errc{} or ptr != last) return std::nullopt;
+        return static_cast<Int>(result);
+    });
+}
+
+/**
+ * @brief Decodes floating point token with std::from_chars,
+ * digit separators and leading plus sign are skipped
+ *
+ * @tparam Float floating point type
+ * @param token number as it appears in the source
+ * @return parsed value or std::nullopt if token is invalid or out of range
+ */
+template <std::floating_point Float>
+std::optional<Float> _parseFloatingPoint(std::string_view token) {
+    return _withoutSeparators(token, [](std::string_view digits)
+                                         -> std::optional<Float> {
+        if (digits.starts_with('+')) {
+            digits.remove_prefix(1);
+            if (digits.starts_with('-')) return std::nullopt;
+        }
+
+        const char* const first = digits.data();
+        const char* const last = first + digits.size();
+
+        Float result{};
+        const auto [ptr, ec] = std::from_chars(first, last, result);
+        if (ec != std::errc{} or ptr != last) return std::nullopt;
+        return result;
+    });
+}
+
+}  // namespace detail
+
+/**
+ * @brief Compile time handle of the value inside of ini file.
+ * Carries section and key names together with their precomputed hash,
+ * so looking value up by handle requires neither hashing nor
+ * constructing key strings.
+ *
+ * #Example:
+ * constexpr my::IniKey port("Server", "port");
+ * constexpr auto host = "Server.host"_key;
+ * auto value = std::get<my::ini::int_t>(ini[port]);
+ *
+ * @note handles can only be built at compile time, which guarantees names
+ * refer to static storage and outlive every ini they are used with
+ */
+struct IniKey {
+    consteval IniKey(std::string_view section, std::string_view key)
+        : section(section), key(key), hash(_hash(section, key)) {
+    }
+
+    std::string_view section;
+    std::string_view key;
+    size_t hash;
+
+    // handles built from the same literals share storage,
+    // so names are compared only when it differs
+    friend constexpr bool operator==(const IniKey& lhs, const IniKey& rhs) {
+        if (lhs.hash != rhs.hash) return false;
+        if (lhs.section.data() == rhs.section.data() and
+            lhs.key.data() == rhs.key.data() and
+            lhs.section.size() == rhs.section.size() and
+            lhs.key.size() == rhs.key.size()) {
+            return true;
+        }
+        return lhs.section == rhs.section and lhs.key == rhs.key;
+    }
+
+   private:
+    // 64 bit FNV-1a of section, '.' and key
+    static constexpr size_t _hash(std::string_view section,
+                                  std::string_view key) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        auto feed = [&hash](char ch) {
+            hash ^= static_cast<unsigned char>(ch);
+            hash *= 0x100000001b3ull;
+        };
+        for (auto ch : section) feed(ch);
+        feed('.');
+        for (auto ch : key) feed(ch);
+        return static_cast<size_t>(hash);
+    }
+};
+
+namespace detail {
+
+/**
+ * @brief Open addressing table of values resolved by IniKey handles.
+ * Each handle lands in the slot of its precomputed hash so repeated reads
+ * are a single indexed load. Slots are stamped with generation, reset()
+ * starts new generation which makes every slot resolve again on next access.
+ *
+ * @note copies and moves start empty as pointers refer to the other object
+ *
+ * @tparam Value type of values
+ */
+template <class Value>
+class _IniSlots {
+   public:
+    _IniSlots() = default;
+    _IniSlots(const _IniSlots&) noexcept {}
+    _IniSlots(_IniSlots&&) noexcept {}
+    _IniSlots& operator=(const _IniSlots&) noexcept {
+        reset();
+        return *this;
+    }
+    _IniSlots& operator=(_IniSlots&&) noexcept {
+        reset();
+        return *this;
+    }
+
+    /**
+     * @brief Returns value of handle, calls resolve(key) to find value
+     * if slot is empty or stale
+     *
+     * @param key handle
+     * @param resolve function returning Value& for provided handle
+     * @return Value& resolved value
+     */
+    template <class Resolve>
+    Value& get(const IniKey& key, Resolve&& resolve) {
+        auto& slot = _slot(key);
+        if (slot.generation != _generation) {
+            // resolve may start new generation itself
+            slot.value = std::addressof(resolve(key));
+            slot.generation = _generation;
+        }
+        return *slot.value;
+    }
+
+    /**
+     * @brief Invalidates every resolved value
+     */
+    void reset() noexcept { ++_generation; }
+
+   private:
+    struct Slot {
+        IniKey key{"", ""};
+        bool used = false;
+        size_t generation = 0;
+        Value* value = nullptr;
+    };
+
+    Slot& _slot(const IniKey& key) {
+        if (_used * 2 >= _table.size()) _grow();
+
+        const size_t mask = _table.size() - 1;
+        for (size_t i = key.hash & mask;; i = (i + 1) & mask) {
+            auto& slot = _table[i];
+            if (not slot.used) {
+                slot.key = key;
+                slot.used = true;
+                ++_used;
+                return slot;
+            }
+            if (slot.key == key) return slot;
+        }
+    }
+
+    void _grow() {
+        std::vector<Slot> table(_table.empty() ? 16 : _table.size() * 2);
+        const size_t mask = table.size() - 1;
+
+        for (auto&& slot : _table) {
+            if (not slot.used) continue;
+            size_t i = slot.key.hash & mask;
+            while (table[i].used) i = (i + 1) & mask;
+            table[i] = slot;
+        }
+
+        _table = std::move(table);
+    }
+
+    std::vector<Slot> _table;
+    size_t _used = 0;
+    size_t _generation = 1;
+};
+
+/**
+ * @brief Source of one section, from its header to the next one.
+ * Text before the first header has empty name
+ *
+ */
+struct _IniChunk {
+    std::string_view name;
+    std::string_view text;
+};
+
+/**
+ * @brief Splits ini source into sections without validating or decoding
+ * anything, only strings and comments are followed so brackets inside of
+ * them are not taken for headers. Boundaries match the ones of my::parseIni
+ * for any valid data, in invalid data the chunk holding the error is the
+ * one that differs from valid source.
+ *
+ * @param data source to split
+ * @return std::vector<_IniChunk> chunks in order of appearance
+ */
+inline std::vector<_IniChunk> _splitIniSections(std::string_view data) {
+    constexpr auto npos = std::string_view::npos;
+    std::vector<_IniChunk> chunks{{{}, data}};
+
+    auto lineStart = [&](size_t pos) {
+        const auto eol = data.rfind('\n', pos);
+        return eol == npos ? 0 : eol + 1;
+    };
+
+    // only brackets and quotes are looked for (with memchr), both are rare
+    // comparing to the rest of the text, so most of it is never touched
+    size_t pos = 0;
+    size_t bracket = data.find('[');
+    size_t quote = data.find('"');
+
+    while (bracket != npos) {
+        if (quote < bracket) {
+            const auto from = std::max(lineStart(quote), pos);
+            const auto prefix = data.substr(from, quote - from);
+
+            if (prefix.find_first_of(";#") != npos) {
+                // quote inside of comment, skip it until the end of line
+                pos = std::min(data.find('\n', quote), data.size());
+            } else {
+                // closing quote is the first one not preceded by backslash
+                pos = quote + 1;
+                do {
+                    pos = data.find('"', pos);
+                    if (pos == npos) return chunks;
+                } while (data[pos++ - 1] == '\\');
+            }
+
+            quote = data.find('"', pos);
+            if (bracket < pos) bracket = data.find('[', pos);
+            continue;
+        }
+
+        const auto from = lineStart(bracket);
+        const auto indent = data.substr(from, bracket - from);
+
+        if (indent.find_first_not_of(" \t") == npos) {
+            auto& last = chunks.back();
+            last.text = {last.text.data(), data.data() + bracket};
+
+            const auto close = std::min(data.find(']', bracket),
+                                        data.find('\n', bracket));
+            chunks.push_back({data.substr(bracket + 1, close - bracket - 1),
+                              data.substr(bracket)});
+        }
+
+        pos = bracket + 1;
+        bracket = data.find('[', pos);
+    }
+
+    return chunks;
+}
+
+/**
+ * @brief Layout of IniSnapshot file. Header is followed by table of
+ * sections, table of entries and table of strings, each table is 8 byte
+ * aligned. Sections and entries of each section are sorted by name so they
+ * are looked up by binary search right in the mapped memory
+ *
+ */
+struct _IniSnapshotHeader {
+    static constexpr std::array<char, 8> signature{'M', 'Y', 'I', 'N',
+                                                   'I', 'S', 'N', 'P'};
+    static constexpr uint32_t currentVersion = 1;
+    static constexpr uint32_t nativeOrder = 0x01020304;
+
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint64_t sectionCount;
+    uint64_t entryCount;
+    uint64_t stringsSize;
+};
+
+struct _IniSnapshotString {
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct _IniSnapshotSection {
+    _IniSnapshotString name;
+    uint64_t firstEntry;
+    uint64_t entryCount;
+};
+
+// type is index of alternative in value variant, value holds its bits
+// or offset of string, size is used only by strings
+struct _IniSnapshotEntry {
+    _IniSnapshotString key;
+    uint64_t type;
+    uint64_t value;
+    uint64_t size;
+};
+
+// size and modification time snapshot was taken from
+inline std::pair<uint64_t, int64_t> _iniSourceStamp(
+    const std::filesystem::path& source) {
+    return {std::filesystem::file_size(source),
+            static_cast<int64_t>(std::filesystem::last_write_time(source)
+                                     .time_since_epoch()
+                                     .count())};
+}
+
+inline std::pair<uint64_t, int64_t> _iniSourceStamp(
+    const std::filesystem::path& source, std::error_code& ec) {
+    const auto size = std::filesystem::file_size(source, ec);
+    if (ec) return {};
+    const auto time = std::filesystem::last_write_time(source, ec);
+    if (ec) return {};
+    return {size, static_cast<int64_t>(time.time_since_epoch().count())};
+}
+
+// name next to path no other writer picks, neither in this process
+// nor in another one
+inline std::filesystem::path _iniTemporaryPath(
+    const std::filesystem::path& path) {
+    static std::atomic<uint64_t> counter = 0;
+    const uint64_t salt = (uint64_t(std::random_device{}()) << 32) ^
+                          std::random_device{}() ^ counter.fetch_add(1);
+
+    auto result = path;
+    result += my::format(".{:016x}.tmp", salt);
+    return result;
+}
+
+}  // namespace detail
+
+/**
+ * @brief exception type thrown when parsing fails
+ *
+ */
+class IniParseException : public std::runtime_error {
+   public:
+    template <class... Args>
+    explicit IniParseException(const char* fmt, Args&&... args)
+        : runtime_error(my::format(fmt, std::forward<Args>(args)...)) {
+    }
+};
+
+namespace ini {
+
+using bool_t = bool;
+using float_t = double;
+using int_t = int64_t;
+using string_t = std::string;
+struct null_t {};
+
+/**
+ * @brief Kind of value as it was recognized by parser
+ *
+ */
+enum class ValueType {
+    Null,
+    Boolean,
+    Integer,
+    BinInteger,
+    OctInteger,
+    HexInteger,
+    FloatingPoint,
+    String,
+};
+
+/**
+ * @brief Emitted by my::parseIni for each section declaration
+ *
+ */
+struct SectionEvent {
+    std::string_view name;
+    size_t line;
+};
+
+/**
+ * @brief Emitted by my::parseIni for each comment, text is everything after
+ * comment sign until the end of line
+ *
+ */
+struct CommentEvent {
+    std::string_view text;
+    size_t line;
+};
+
+/**
+ * @brief Emitted by my::parseIni for each key-value pair.
+ * Value is kept as raw view into parsed data (numbers with their prefixes
+ * and separators, strings without quotes but with escapes),
+ * decoding methods convert it on demand and throw IniParseException
+ * if it is invalid
+ *
+ */
+struct ValueEvent {
+    std::string_view section;
+    std::string_view key;
+    std::string_view raw;
+    ValueType type;
+    size_t line;
+
+    /**
+     * @brief Decodes boolean value
+     */
+    bool_t boolean() const {
+        assert(type == ValueType::Boolean);
+        return raw == "true";
+    }
+
+    /**
+     * @brief Decodes integer of any base
+     */
+    int_t integer() const {
+        auto decode = [this](std::string_view digits, int base,
+                             const char* name) {
+            const auto result = detail::_parseInteger<int_t>(digits, base);
+            if (not result) {
+                throw IniParseException(
+                    "Value \"{}\" is invalid {} value:{}",
+                    digits, name, line);
+            }
+            return *result;
+        };
+
+        switch (type) {
+            case ValueType::BinInteger:
+                return decode(raw.substr(2), 2, "binary");
+            case ValueType::OctInteger:
+                return decode(raw.substr(2), 8, "octal");
+            case ValueType::HexInteger:
+                return decode(raw.substr(2), 16, "hexadecimal");
+            default:
+                assert(type == ValueType::Integer);
+                return decode(raw, 10, "integral");
+        }
+    }
+
+    /**
+     * @brief Decodes floating point value
+     */
+    float_t floatingPoint() const {
+        assert(type == ValueType::FloatingPoint);
+        const auto result = detail::_parseFloatingPoint<float_t>(raw);
+        if (not result) {
+            throw IniParseException(
+                "Value \"{}\" is invalid floating "
+                "point value:{}",
+                raw, line);
+        }
+        return *result;
+    }
+
+    /**
+     * @brief Copies string value replacing \" with quote
+     */
+    string_t string() const {
+        assert(type == ValueType::String);
+        if (raw.find("\\\"") == raw.npos) return string_t(raw);
+
+        string_t result;
+        result.reserve(raw.size());
+        for (size_t i = 0; i < raw.size(); ++i) {
+            if (raw[i] == '\\' and i + 1 < raw.size() and raw[i + 1] == '"') {
+                continue;
+            }
+            result.push_back(raw[i]);
+        }
+        return result;
+    }
+};
+
+}  // namespace ini
+
+/**
+ * @brief Event based parser of ini dialect described in my::Ini.
+ * Scans contiguous buffer with pointers and calls handler for each
+ * ini::SectionEvent, ini::ValueEvent and ini::CommentEvent with views into
+ * data. Nothing is stored, so memory use is constant regardless of the size
+ * of data. Handler may accept only events it is interested in, the rest
+ * are skipped.
+ * @note throws IniParseException if data is malformed
+ *
+ * #Example:
+ * my::parseIni(data, [](const my::ini::ValueEvent& event) {
+ *     if (event.key == "port") std::cout << event.integer();
+ * });
+ *
+ * @param data buffer to parse
+ * @param handler callable with any of event types
+ */
+template <class Handler>
+void parseIni(std::string_view data, Handler&& handler) {
+    using char_t = char;
+    using enum ini::ValueType;
+
+    // giving stuff self explanatory names
+    static auto isLower = [](char_t ch) -> bool {
+        return ch >= 'a' and ch <= 'z';
+    };
+    static auto isUpper = [](char_t ch) -> bool {
+        return ch >= 'A' and ch <= 'Z';
+    };
+    static auto isAlpha = [](char_t ch) -> bool {
+        return isLower(ch) or isUpper(ch);
+    };
+    static auto isBinDigit = [](char_t ch) -> bool {
+        return ch == '1' or ch == '0';
+    };
+    static auto isOctDigit = [](char_t ch) -> bool {
+        return ch >= '0' and ch <= '7';
+    };
+    static auto isDigit = [](char_t ch) -> bool {
+        return ch >= '0' and ch <= '9';
+    };
+    static auto isHexDigit = [](char_t ch) -> bool {
+        return isDigit(ch) or
+               (ch >= 'A' and ch <= 'F') or
+               (ch >= 'a' and ch <= 'f');
+    };
+    static auto isComment = [](char_t ch) -> bool { return ch == ';' or
+                                                           ch == '#'; };
+    static auto isSpace = [](char_t ch) -> bool { return ch == ' ' or
+                                                         ch == '\t'; };
+    static auto isExponent = [](char_t ch) -> bool {
+        return ch == 'E' or ch == 'e';
+    };
+
+    static auto isSectionOpen = [](char_t ch) -> bool { return ch == '['; };
+    static auto isSectionClose = [](char_t ch) -> bool { return ch == ']'; };
+    static auto isQuote = [](char_t ch) -> bool { return ch == '"'; };
+    static auto isDot = [](char_t ch) -> bool { return ch == '.'; };
+    static auto isMinus = [](char_t ch) -> bool { return ch == '-'; };
+    static auto isPlus = [](char_t ch) -> bool { return ch == '+'; };
+    static auto isUnderscore = [](char_t ch) -> bool { return ch == '_'; };
+    static auto isSingleQuote = [](char_t ch) -> bool { return ch == '\''; };
+    static auto isEndline = [](char_t ch) -> bool { return ch == '\n'; };
+    static auto isBackslash = [](char_t ch) -> bool { return ch == '\\'; };
+    static auto isEquals = [](char_t ch) -> bool { return ch == '='; };
+
+    static auto isTrueStart = [](char_t ch) -> bool { return ch == 't'; };
+    static auto isFalseStart = [](char_t ch) -> bool { return ch == 'f'; };
+    static auto isNullStart = [](char_t ch) -> bool { return ch == 'n'; };
+
+    static auto isKeyChar = [](char_t ch) -> bool {
+        return isAlpha(ch) or isDigit(ch) or isUnderscore(ch);
+    };
+    static auto isSeparator = [](char_t ch) -> bool {
+        return isUnderscore(ch) or isSingleQuote(ch);
+    };
+    static auto isTokenEnd = [](char_t ch) -> bool {
+        return isSpace(ch) or isComment(ch) or isEndline(ch);
+    };
+
+    const char_t* it = data.data();
+    const char_t* const end = it + data.size();
+    size_t line = 1;
+    std::string_view section;
+    bool sectionDeclared = false;
+
+    auto emit = [&handler](const auto& event) {
+        if constexpr (std::invocable<Handler&, decltype(event)>) {
+            std::invoke(handler, event);
+        }
+    };
+
+    auto skipSpaces = [&] {
+        while (it != end and isSpace(*it)) ++it;
+    };
+
+    // comment lasts until endline, endline itself is left to the caller
+    auto readComment = [&] {
+        const char_t* begin = ++it;
+        it = std::find(it, end, '\n');
+        emit(ini::CommentEvent{std::string_view(begin, it), line});
+    };
+
+    // consumes everything after value or section declaration until
+    // next line, throws in case there is something that is not
+    // a whitespace, endline or comment
+    auto consumeTrailing = [&] {
+        skipSpaces();
+        if (it == end) return;
+        if (isComment(*it)) readComment();
+        if (it == end) return;
+        if (isEndline(*it)) {
+            ++it, ++line;
+            return;
+        }
+        throw IniParseException(
+            "Only trailing spaces, comment or "
+            "newline is required after value:{}",
+            line);
+    };
+
+    // number and keyword tokens last until whitespace, comment or endline
+    auto scanToken = [&] {
+        const char_t* begin = it;
+        while (it != end and not isTokenEnd(*it)) ++it;
+        return std::string_view(begin, it);
+    };
+
+    // Reads quoted string, quote preceded by backslash is preserved
+    // as is, all other chars are read as-is (including endlines)
+    auto scanString = [&] {
+        const char_t* begin = it;
+
+        for (;; ++it) {
+            it = std::find_if(it, end, [](char_t ch) {
+                return isQuote(ch) or isEndline(ch);
+            });
+
+            if (it == end) {
+                throw IniParseException(
+                    "String value must be closed with quote:{}", line);
+            }
+
+            if (isEndline(*it)) {
+                ++line;
+                continue;
+            }
+
+            if (it != begin and isBackslash(*(it - 1))) continue;
+
+            break;
+        }
+
+        return std::string_view(begin, it++);
+    };
+
+    // We receive all supported chars even if it is prohibited,
+    // Then when value is decoded we parse it with
+    // std::from_chars that will handle all errors for us
+    // It would be really tough to prevent repetitive exponent or
+    // plus/minus signs using separate states
+    auto checkFloatingPoint = [&](std::string_view token) {
+        for (auto ch : token) {
+            if (not(isDigit(ch) or isExponent(ch) or isDot(ch) or
+                    isPlus(ch) or isMinus(ch) or isSeparator(ch))) {
+                throw IniParseException(
+                    "Invalid symbol \"{}\" in floating point "
+                    "number:{}",
+                    ch, line);
+            }
+        }
+        return FloatingPoint;
+    };
+
+    // Read all digits skip all separators if dot is found then
+    // it is float
+    // If any inappropriate symbol found - throw
+    auto checkNumber = [&](std::string_view token) {
+        for (size_t i = 0; i < token.size(); ++i) {
+            const auto ch = token[i];
+
+            if (isDot(ch)) return checkFloatingPoint(token);
+            if (isSeparator(ch)) continue;
+            if (i == 0 and (isPlus(ch) or isMinus(ch))) continue;
+
+            if (not isDigit(ch)) {
+                throw IniParseException(
+                    "Integer must only contain digits "
+                    "in range [0 - 9]:{}",
+                    line);
+            }
+        }
+        return Integer;
+    };
+
+    // bin, hex, oct are basically all the same
+    // skip separators, throw if not appropriate digit
+    auto checkRadixInteger = [&](std::string_view token, auto isRadixDigit,
+                                 const char* message) {
+        for (auto ch : token.substr(2)) {
+            if (isSeparator(ch)) continue;
+            if (not isRadixDigit(ch)) throw IniParseException(message, line);
+        }
+    };
+
+    // Here we determine what value possibly will be
+    // If we reached endline or comment value is null
+    // If it is quote then it is string value
+    // If it is hex, bin or oct starting sequence it is
+    // appropriate integer
+    // If it is just a digit or leading plus or minus sign it is
+    // integer (with possibility that it is float)
+    // If it is leading dot it is float
+    // If it is first char of null, true or false token it is
+    // respective keyword
+    // Else we throw
+    auto readValue = [&](std::string_view key) {
+        ini::ValueEvent event{section, key, {}, Null, line};
+
+        if (it == end or isComment(*it) or isEndline(*it)) {
+            emit(event);
+            return;
+        }
+
+        const auto ch = *it;
+        const auto next = it + 1 != end ? *(it + 1) : '\0';
+
+        if (isQuote(ch)) {
+            ++it;
+            event.raw = scanString();
+            event.type = String;
+        } else if (ch == '0' and next == 'x') {
+            event.raw = scanToken();
+            event.type = HexInteger;
+            checkRadixInteger(
+                event.raw, isHexDigit,
+                "Hexadecimal integer must only contain digits "
+                "in range [0 - 9] and chars in range [A - F]:{}");
+        } else if (ch == '0' and next == 'b') {
+            event.raw = scanToken();
+            event.type = BinInteger;
+            checkRadixInteger(
+                event.raw, isBinDigit,
+                "Binary integer must only contain "
+                "0 and 1 digits:{}");
+        } else if (ch == '0' and next == 'o') {
+            event.raw = scanToken();
+            event.type = OctInteger;
+            checkRadixInteger(
+                event.raw, isOctDigit,
+                "Octal integer must only contain "
+                "digits in range [0 - 7]:{}");
+        } else if (isDigit(ch) or isMinus(ch) or isPlus(ch)) {
+            event.raw = scanToken();
+            event.type = checkNumber(event.raw);
+        } else if (isDot(ch)) {
+            event.raw = scanToken();
+            event.type = checkFloatingPoint(event.raw);
+        } else if (isTrueStart(ch) or isFalseStart(ch)) {
+            // boolean and null are keywords so we parse them in a similar
+            // fashion, check if value read is appropriate keyword
+            // throw otherwise
+            event.raw = scanToken();
+            event.type = Boolean;
+            if (event.raw != "true" and event.raw != "false") {
+                throw IniParseException(
+                    "Value \"{}\" is invalid boolean value:{}",
+                    event.raw, line);
+            }
+        } else if (isNullStart(ch)) {
+            event.raw = scanToken();
+            if (event.raw != "null") {
+                throw IniParseException(
+                    "Value \"{}\" is invalid null value:{}",
+                    event.raw, line);
+            }
+        } else {
+            throw IniParseException(
+                "Value must be either quoted string, number, "
+                "boolean, or null (empty line):{}",
+                line);
+        }
+
+        emit(event);
+    };
+
+    while (it != end) {
+        // Each next line potentially can be empty or contain spaces
+        // we need to consume it and wait until section token or any
+        // alpha-numeric char appears
+        if (isEndline(*it)) {
+            ++it, ++line;
+            continue;
+        }
+
+        if (isSpace(*it)) {
+            ++it;
+            continue;
+        }
+
+        if (isComment(*it)) {
+            readComment();
+            continue;
+        }
+
+        // If open section token was read
+        // we reading all alpha-numeric chars until it's closed
+        // In case of empty section or non alpha-numeric char we throw
+        if (isSectionOpen(*it)) {
+            const char_t* begin = ++it;
+            while (it != end and (isAlpha(*it) or isDigit(*it))) ++it;
+
+            if (it == end or not isSectionClose(*it)) {
+                throw IniParseException(
+                    "Section name must contain only "
+                    "alpha numeric chars:{}",
+                    line);
+            }
+
+            if (it == begin) {
+                throw IniParseException(
+                    "Section name must not be empty:{}",
+                    line);
+            }
+
+            section = std::string_view(begin, it++);
+            sectionDeclared = true;
+            emit(ini::SectionEvent{section, line});
+            consumeTrailing();
+            continue;
+        }
+
+        // Only three possible cases before first section
+        // we either got empty line with spaces, comment or section
+        // in any other case we throw
+        if (not sectionDeclared) {
+            throw IniParseException("File must start from section:{}",
+                                    line);
+        }
+
+        // Key is read until whitespace or equals sign
+        // In case we received non alpha-numeric char we throw
+        const char_t* begin = it;
+        while (it != end and isKeyChar(*it)) ++it;
+        const std::string_view key(begin, it);
+
+        if (key.empty() or (it != end and not isSpace(*it) and
+                            not isEquals(*it) and not isComment(*it))) {
+            throw IniParseException(
+                "Key must contain only alpha "
+                "numeric chars:{}",
+                line);
+        }
+
+        if (it != end and isComment(*it)) {
+            throw IniParseException(
+                "Comments is prohibited inside "
+                "of key declaration:{}",
+                line);
+        }
+
+        // Consume all spaces until equals sign is found
+        // throw if any other char appears
+        skipSpaces();
+        if (it == end or not isEquals(*it)) {
+            if (it == key.data() + key.size()) {
+                throw IniParseException(
+                    "Key must contain only alpha "
+                    "numeric chars:{}",
+                    line);
+            }
+            throw IniParseException(
+                "Key must not contain spaces:{}",
+                line);
+        }
+
+        ++it;
+        skipSpaces();
+
+        readValue(key);
+        consumeTrailing();
+    }
+}
+
+/**
+ * @brief Read-only view of ini saved by Ini::writeSnapshot().
+ * Snapshot file is mapped into memory as-is, nothing is parsed or copied,
+ * values are found with binary search over tables of the file and strings
+ * are returned as views into the mapping, so opening costs only the page
+ * faults of touched pages.
+ *
+ * #Example:
+ * if (auto snapshot = my::IniSnapshot::load("app.ini.snap", "app.ini")) {
+ *     auto port = std::get<my::ini::int_t>(snapshot->at("Server", "port"));
+ * }
+ *
+ * @note snapshot has host byte order and is not meant to be moved between
+ * machines, incompatible snapshots are rejected
+ */
+class IniSnapshot {
+   public:
+    using value_t = std::variant<ini::null_t, ini::bool_t, ini::float_t,
+                                 ini::int_t, std::string_view>;
+
+    /**
+     * @brief Maps snapshot located at path
+     * @note throws std::system_error if file can not be mapped and
+     * IniParseException if it is not a snapshot of supported version
+     *
+     * @param path path to the snapshot
+     */
+    explicit IniSnapshot(const std::filesystem::path& path)
+        : _file(path) {
+        using header_t = detail::_IniSnapshotHeader;
+
+        if (_file.size() < sizeof(header_t)) {
+            throw IniParseException("Snapshot is truncated: {}",
+                                    path.string());
+        }
+
+        const auto& header = _header();
+        if (header.magic != header_t::signature) {
+            throw IniParseException("File is not ini snapshot: {}",
+                                    path.string());
+        }
+        if (header.version != header_t::currentVersion or
+            header.byteOrder != header_t::nativeOrder) {
+            throw IniParseException("Snapshot version is not supported: {}",
+                                    path.string());
+        }
+
+        const auto tables =
+            header.sectionCount * sizeof(detail::_IniSnapshotSection) +
+            header.entryCount * sizeof(detail::_IniSnapshotEntry);
+        if (header.sectionCount > _file.size() or
+            header.entryCount > _file.size() or
+            sizeof(header_t) + tables + header.stringsSize != _file.size()) {
+            throw IniParseException("Snapshot is truncated: {}",
+                                    path.string());
+        }
+    }
+
+    /**
+     * @brief Maps snapshot only if it was taken from source in its
+     * current state
+     *
+     * @param snapshot path to the snapshot
+     * @param source path to the text file snapshot was taken from
+     * @return std::optional<IniSnapshot> snapshot or std::nullopt if it is
+     * missing, stale or incompatible
+     */
+    static std::optional<IniSnapshot> load(
+        const std::filesystem::path& snapshot,
+        const std::filesystem::path& source) {
+        try {
+            IniSnapshot result(snapshot);
+            if (not result.freshFor(source)) return std::nullopt;
+            return result;
+        } catch (const std::system_error&) {
+            return std::nullopt;
+        } catch (const IniParseException&) {
+            return std::nullopt;
+        }
+    }
+
+    /**
+     * @brief Checks if source has the same size and modification time as
+     * when snapshot was taken
+     */
+    bool freshFor(const std::filesystem::path& source) const {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(source, ec);
+        if (ec) return false;
+        const auto time = std::filesystem::last_write_time(source, ec);
+        if (ec) return false;
+
+        return _header().sourceSize == size and
+               _header().sourceTime == time.time_since_epoch().count();
+    }
+
+    /**
+     * @return Number of sections in snapshot
+     */
+    size_t size() const noexcept { return _sections().size(); }
+
+    bool contains(std::string_view section, std::string_view key) const {
+        return _find(section, key) != nullptr;
+    }
+
+    /**
+     * @brief Access particular value
+     * @note throws std::out_of_range if there is no such section or key
+     *
+     * @param section name of section
+     * @param key name of key
+     * @return value_t value, strings are views into the snapshot
+     */
+    value_t at(std::string_view section, std::string_view key) const {
+        const auto* entry = _find(section, key);
+        if (not entry) throw std::out_of_range("IniSnapshot::at");
+        return _value(*entry);
+    }
+
+    /**
+     * @brief Calls handler(section, key, value) for each value in order of
+     * sections and keys, and handler(section) before values of each section
+     * if handler accepts it
+     *
+     * @param handler callable with std::string_view, std::string_view and
+     * value_t
+     */
+    template <class Handler>
+    void visit(Handler&& handler) const {
+        for (auto&& section : _sections()) {
+            const auto name = _string(section.name);
+            if constexpr (std::invocable<Handler&, std::string_view>) {
+                std::invoke(handler, name);
+            }
+            for (auto&& entry : _entries(section)) {
+                std::invoke(handler, name, _string(entry.key), _value(entry));
+            }
+        }
+    }
+
+   private:
+    using header_t = detail::_IniSnapshotHeader;
+    using section_t = detail::_IniSnapshotSection;
+    using entry_t = detail::_IniSnapshotEntry;
+
+    const header_t& _header() const {
+        return *reinterpret_cast<const header_t*>(_file.data());
+    }
+
+    std::span<const section_t> _sections() const {
+        return {reinterpret_cast<const section_t*>(_file.data() +
+                                                   sizeof(header_t)),
+                _header().sectionCount};
+    }
 
-        ss << std::boolalpha
-           << std::showpoint
-           << std::setprecision(std::numeric_limits<T>::max_digits10)
-           << obj._value;
+    std::span<const entry_t> _entries(const section_t& section) const {
+        const auto* entries = reinterpret_cast<const entry_t*>(
+            _sections().data() + _sections().size());
+        if (section.firstEntry > _header().entryCount or
+            section.entryCount > _header().entryCount - section.firstEntry) {
+            throw std::out_of_range("IniSnapshot: corrupted section");
+        }
+        return {entries + section.firstEntry, section.entryCount};
+    }
 
-        auto num = ss.str();
-        num = num.substr(0, num.find_last_not_of('0') + 1);
-        if (num.back() == '.') num.push_back('0');
-        os << num;
+    std::string_view _string(uint64_t offset, uint64_t size) const {
+        const auto strings = _file.view().substr(_file.size() -
+                                                 _header().stringsSize);
+        if (offset > strings.size() or size > strings.size() - offset) {
+            throw std::out_of_range("IniSnapshot: corrupted string");
+        }
+        return strings.substr(offset, size);
+    }
 
-        return os;
+    std::string_view _string(const detail::_IniSnapshotString& string) const {
+        return _string(string.offset, string.size);
     }
 
-   private:
-    T _value;
-};
+    value_t _value(const entry_t& entry) const {
+        switch (entry.type) {
+            case 1: return entry.value != 0;
+            case 2: return std::bit_cast<ini::float_t>(entry.value);
+            case 3: return static_cast<ini::int_t>(entry.value);
+            case 4: return _string(entry.value, entry.size);
+            default: return ini::null_t{};
+        }
+    }
 
-}  // namespace detail
+    const entry_t* _find(std::string_view section, std::string_view key) const {
+        auto byName = [this](const auto& record, std::string_view name) {
+            return _string(record.name) < name;
+        };
+        auto byKey = [this](const entry_t& record, std::string_view name) {
+            return _string(record.key) < name;
+        };
 
-/**
- * @brief exception type thrown when parsing fails
- *
- */
-class IniParseException : public std::runtime_error {
-   public:
-    template <class... Args>
-    explicit IniParseException(const char* fmt, Args&&... args)
-        : runtime_error(my::format(fmt, std::forward<Args>(args)...)) {
+        const auto sections = _sections();
+        const auto found =
+            std::lower_bound(sections.begin(), sections.end(), section, byName);
+        if (found == sections.end() or _string(found->name) != section) {
+            return nullptr;
+        }
+
+        const auto entries = _entries(*found);
+        const auto entry =
+            std::lower_bound(entries.begin(), entries.end(), key, byKey);
+        if (entry == entries.end() or _string(entry->key) != key) {
+            return nullptr;
+        }
+        return &*entry;
     }
+
+    MappedFile _file;
 };
 
 /**
@@ -99,6 +1258,11 @@ class IniParseException : public std::runtime_error {
  *
  *     It is ok to repeat sections and values in sections, the general behaviour
  *     in such situations defined by map class provided or std::map by default.
+ *     Any map with std::map like interface can be used, e.g. my::FlatMap stores
+ *     sections and keys in hashed contiguous vectors which is much faster to
+ *     look up than std::map and keeps sections and keys in order of appearance:
+ *       example:
+ *         my::Ini<my::FlatMap> flat("[Section]\nkey = 42");
  *     With std::map as Map class, behaviour is the following:
  *     If section appears more than once all values will be written into one
  *     section with this name, if values of section occurs more than once, only
@@ -122,8 +1286,9 @@ class IniParseException : public std::runtime_error {
  *           bValue2 = false
 
  *     integer:
- *       Integer is parsed with default c++ std::istream operator>> and can be either
- *       decimal, octal, binary or hexadecimal
+ *       Integer is parsed with std::from_chars into int64_t and can be either
+ *       decimal, octal, binary or hexadecimal. Octal, binary and hexadecimal
+ *       integers are read as 64 bit pattern so 0xFFFFFFFFFFFFFFFF is -1
  *       It is allowed to use prefix minus and plus
  *       Also it is allowed to use ' and _ chars as separators, while reading it will be
  *       simply consumed so you can use it in any quantity and order as you want
@@ -139,7 +1304,7 @@ class IniParseException : public std::runtime_error {
  *           iSeparated2 = 1_000_000_000_000
 
  *     floating point:
- *       Floating point numbers as well as integers are parsed with default std::istream operator>>
+ *       Floating point numbers as well as integers are parsed with std::from_chars
  *       and can have plus minus sign, exponent and dot in the beginning and end of number
  *         example:
  *           [Floats]
@@ -200,6 +1365,18 @@ class IniParseException : public std::runtime_error {
  *      Using constructor from string:
  *        my::ini usingStrConstructor(in);
  *
+ *      Using memory mapped file, keys and values are scanned in place and
+ *      copied only when stored:
+ *        my::ini usingFile;
+ *        usingFile.readFile("ini-file.ini");
+ *        auto alsoUsingFile = my::Ini<>::fromFile("ini-file.ini");
+ *
+ *      Using my::parseIni directly, nothing is stored, handler receives
+ *      section, value and comment events with views into data:
+ *        my::parseIni(str, [](const my::ini::ValueEvent& event) {
+ *            std::cout << event.section << '.' << event.key << '\n';
+ *        });
+ *
  *  Serializing data:
  *      There is also several methods to serialize data back into string
  *
@@ -211,6 +1388,40 @@ class IniParseException : public std::runtime_error {
  *        my::ini data;
  *        std::string result = data.dump();
  *
+ *      Using write() method with string, output is appended to it, so
+ *      the same buffer can be reused for repetitive serialization:
+ *        std::string buffer;
+ *        data.write(buffer);
+ *        buffer.clear();
+ *
+ * Compile time handles:
+ *      Values which are accessed repeatedly can be looked up by IniKey handle,
+ *      its hash is computed at compile time and the value is resolved into
+ *      slot of particular ini on the first access, so next accesses are
+ *      single indexed load
+ *        example:
+ *          constexpr my::IniKey fNegative("Floats", "fNegative");
+ *          auto value = std::get<my::ini::float_t>(data[fNegative]);
+ *          auto same = std::get<my::ini::float_t>(data["Floats.fNegative"_key]);
+ *
+ * Binary snapshot:
+ *      Parsed data can be saved into binary snapshot which is then mapped
+ *      into memory without parsing, text is parsed again only when it has
+ *      changed since snapshot was taken
+ *        example:
+ *          auto config = my::Ini<>::fromSnapshot("app.ini.snap", "app.ini");
+ *          auto view = my::IniSnapshot::load("app.ini.snap", "app.ini");
+ *
+ * Reloading:
+ *      When file changes, reload() brings ini to its new contents parsing
+ *      only sections which source changed, and returns added, removed and
+ *      changed keys
+ *        example:
+ *          my::ini config;
+ *          config.reload(my::MappedFile("config.ini"));
+ *          // ... file changed
+ *          for (auto&& [section, key] : config.reload(text).changed) { ... }
+ *
  * Merge patch:
  *      Just like stl::map, my::ini also has method merge()
  *      The behaviour of this function is the following:
@@ -254,13 +1465,34 @@ class Ini {
     using float_t = double;
     using int_t = int64_t;
     using string_t = std::string;
-    struct null_t {};
+    struct null_t {
+        constexpr bool operator==(const null_t&) const = default;
+    };
 
     using key_t = string_t;
     using value_t = std::variant<null_t, bool_t, float_t, int_t, string_t>;
     using container_t = Map<key_t, value_t>;
     using char_t = string_t::value_type;
 
+    /**
+     * @brief Keys affected by reload(), each entry is pair of section name
+     * and key name
+     *
+     */
+    struct diff_t {
+        using entry_t = std::pair<key_t, key_t>;
+
+        std::vector<entry_t> added;
+        std::vector<entry_t> removed;
+        std::vector<entry_t> changed;
+
+        bool empty() const noexcept {
+            return added.empty() and removed.empty() and changed.empty();
+        }
+    };
+
+    struct loaded_t;
+
    public:
     // constructors
 
@@ -282,9 +1514,118 @@ class Ini {
      *
      * @param data string to parse
      */
-    explicit Ini(const string_t& data) {
-        std::stringstream ss(data);
-        read(ss);
+    explicit Ini(std::string_view data) { read(data); }
+
+    /**
+     * @brief Construct a new ini object from file mapped into memory
+     * @see readFile()
+     *
+     * @param path path to the file to parse
+     * @return Ini parsed file
+     */
+    static Ini fromFile(const std::filesystem::path& path) {
+        Ini result;
+        result.readFile(path);
+        return result;
+    }
+
+    /**
+     * @brief Loads ini from snapshot if it is fresh, otherwise parses
+     * source as text and takes new snapshot of it for the next time
+     * @see IniSnapshot, writeSnapshot()
+     *
+     * #Example:
+     * auto config = my::Ini<>::fromSnapshot("app.ini.snap", "app.ini");
+     *
+     * @param snapshot path to the snapshot
+     * @param source path to the text file
+     * @return Ini loaded file
+     */
+    static Ini fromSnapshot(const std::filesystem::path& snapshot,
+                            const std::filesystem::path& source) {
+        Ini result;
+
+        if (auto view = IniSnapshot::load(snapshot, source)) {
+            result.read(*view);
+            return result;
+        }
+
+        // stamp is taken before reading, so if source changes meanwhile
+        // snapshot is stale rather than claiming newer text it lacks
+        std::error_code ec;
+        const auto stamp = detail::_iniSourceStamp(source, ec);
+
+        result.readFile(source);
+
+        // snapshot is only a cache, failing to write it must not fail
+        // loading of perfectly valid text
+        if (not ec) {
+            try {
+                result._writeSnapshot(snapshot, stamp);
+            } catch (const std::exception&) {
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Parses several files concurrently and merges them in order of
+     * paths, each next file overrides values of previous ones the same way
+     * merge() does, so result does not depend on scheduling.
+     * Files are handed out to worker threads one by one, so a single large
+     * file does not hold back the rest.
+     * @note if any file fails to open or parse, exception of the first such
+     * file (in order of paths) is rethrown once all workers are finished
+     *
+     * #Example:
+     * auto [config, timings] = my::Ini<>::fromFiles(
+     *     {"defaults.ini", "site.ini", "local.ini"});
+     *
+     * @param paths files to parse, later ones take precedence
+     * @param threads number of worker threads, hardware concurrency if 0
+     * @return loaded_t merged ini and parse time of each file
+     */
+    static loaded_t fromFiles(const std::vector<std::filesystem::path>& paths,
+                              size_t threads = 0) {
+        using clock = std::chrono::steady_clock;
+
+        std::vector<Ini> parts(paths.size());
+        std::vector<std::chrono::nanoseconds> timings(paths.size());
+        std::vector<std::exception_ptr> errors(paths.size());
+        std::atomic<size_t> next = 0;
+
+        auto work = [&] {
+            for (size_t i; (i = next.fetch_add(1)) < paths.size();) {
+                const auto start = clock::now();
+                try {
+                    parts[i].readFile(paths[i]);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+                timings[i] = clock::now() - start;
+            }
+        };
+
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        threads = std::clamp<size_t>(threads, 1,
+                                     std::max<size_t>(paths.size(), 1));
+
+        {
+            // calling thread is one of the workers
+            std::vector<std::jthread> workers;
+            workers.reserve(threads - 1);
+            for (size_t i = 1; i < threads; ++i) workers.emplace_back(work);
+            work();
+        }
+
+        for (auto&& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+
+        loaded_t result{Ini(), std::move(timings)};
+        result.ini.merge(std::move(parts));
+        return result;
     }
 
     // convenience operators
@@ -309,6 +1650,7 @@ class Ini {
      * @return container_t& key-value pairs of particular section
      */
     container_t& operator[](const key_t& section) {
+        if constexpr (not _stableReferences) _slots.reset();
         return _sections[section];
     }
 
@@ -331,9 +1673,57 @@ class Ini {
      * @return container_t& key-value pairs of particular section
      */
     container_t& at(const key_t& section) {
+        if constexpr (not _stableReferences) _slots.reset();
         return _sections.at(section);
     }
 
+    // access to particular value by compile time handle
+
+    /**
+     * @brief Access particular value by compile time handle.
+     * First access resolves handle into slot of this object, each next one
+     * is single indexed load without hashing or comparing strings
+     * @note inserts null value (and section) if there where no such value
+     * @see IniKey
+     *
+     * @param key compile time handle of section and key
+     * @return value_t& value
+     */
+    value_t& operator[](const IniKey& key) {
+        return _slots.get(key, [this](const IniKey& key) -> value_t& {
+            auto [section, sectionInserted] =
+                _sections.try_emplace(key_t(key.section));
+            auto [value, valueInserted] =
+                section->second.try_emplace(key_t(key.key));
+
+            if constexpr (not _stableReferences) {
+                if (sectionInserted or valueInserted) _slots.reset();
+            }
+            return value->second;
+        });
+    }
+
+    /**
+     * @brief Access particular value by compile time handle
+     * @note throws if there where no such section or key
+     * @see IniKey
+     *
+     * @param key compile time handle of section and key
+     * @return const value_t& value
+     */
+    const value_t& at(const IniKey& key) const {
+        return _at(_at(_sections, key.section), key.key);
+    }
+
+    /**
+     * @brief Drops every value resolved by IniKey handles.
+     * Must be called after erasing values through data(), operator->() or
+     * section reference, for maps that invalidate references on insertion
+     * (e.g. my::FlatMap) - after any modification made that way
+     *
+     */
+    void resetSlots() noexcept { _slots.reset(); }
+
     /**
      * @brief Merge patch current file with other.
      * Each new value of section will be inserted, each different value will
@@ -343,6 +1733,9 @@ class Ini {
      * @return size_t amount of inserted and changed values
      */
     size_t merge(const Ini& rhs) {
+        if constexpr (not _stableReferences) _slots.reset();
+        _forgetSource();
+
         size_t mutated = 0;
 
         for (auto&& section : rhs._sections) {
@@ -362,12 +1755,98 @@ class Ini {
         return mutated;
     }
 
+    /**
+     * @brief Merge patch current file with other, which is going to be
+     * discarded. Same as merge(const Ini&), but nothing is copied: sections
+     * and values missing here are spliced (nodes are relinked for node based
+     * maps), the rest of values are moved
+     * @note rhs is left empty
+     *
+     * @param rhs other ini file to merge with
+     * @return size_t amount of inserted and changed values
+     */
+    size_t merge(Ini&& rhs) {
+        if constexpr (not _stableReferences) _slots.reset();
+        _forgetSource();
+        rhs._slots.reset();
+        rhs._forgetSource();
+
+        size_t mutated = 0;
+
+        if constexpr (_stableReferences) {
+            auto& sections = rhs._sections;
+            for (auto it = sections.begin(); it != sections.end();) {
+                mutated += it->second.size();
+
+                auto target = _sections.find(it->first);
+                if (target == _sections.end()) {
+                    _sections.insert(sections.extract(it++));
+                    continue;
+                }
+                _splice(target->second, it->second);
+                ++it;
+            }
+        } else {
+            for (auto&& section : _release(rhs._sections)) {
+                mutated += section.second.size();
+
+                auto [target, inserted] =
+                    _sections.try_emplace(std::move(section.first));
+                if (inserted) {
+                    target->second = std::move(section.second);
+                    continue;
+                }
+                _splice(target->second, section.second);
+            }
+        }
+
+        // whatever left in rhs is moved from
+        rhs._sections.clear();
+
+        return mutated;
+    }
+
+    /**
+     * @brief Merge patch current file with each ini of range in order,
+     * later ones take precedence. Elements are moved from if range is passed
+     * as rvalue or yields rvalues (e.g. std::move(vector) or
+     * std::views::as_rvalue), copied otherwise
+     *
+     * #Example:
+     * std::vector<my::Ini<>> layers = ...;
+     * config.merge(std::move(layers));
+     *
+     * @param range range of ini files to merge with
+     * @return size_t amount of inserted and changed values
+     */
+    template <std::ranges::input_range R>
+        requires std::same_as<std::ranges::range_value_t<R>, Ini>
+    size_t merge(R&& range) {
+        constexpr bool movable =
+            std::is_rvalue_reference_v<std::ranges::range_reference_t<R>> or
+            (std::is_rvalue_reference_v<R&&> and
+             not std::ranges::borrowed_range<R>);
+
+        size_t mutated = 0;
+        for (auto&& rhs : range) {
+            if constexpr (movable) {
+                mutated += merge(std::move(rhs));
+            } else {
+                mutated += merge(std::as_const(rhs));
+            }
+        }
+        return mutated;
+    }
+
     // access to internal buffer
 
     /**
      * @brief Access internal methods via pointer to std::map<key_t, container_t>
      */
-    constexpr auto* operator->() { return &_sections; }
+    constexpr auto* operator->() {
+        if constexpr (not _stableReferences) _slots.reset();
+        return &_sections;
+    }
     /**
      * @brief Access internal methods via pointer to std::map<key_t, container_t>
      */
@@ -376,7 +1855,10 @@ class Ini {
     /**
      * @brief Access internal methods reference to std::map<key_t, container_t>
      */
-    constexpr auto& data() { return _sections; }
+    constexpr auto& data() {
+        if constexpr (not _stableReferences) _slots.reset();
+        return _sections;
+    }
     /**
      * @brief Access internal methods reference to std::map<key_t, container_t>
      */
@@ -385,28 +1867,49 @@ class Ini {
     // serialize deserialize
 
     /**
-     * @brief Explicit call to serialization function
+     * @brief Explicit call to serialization function.
+     * Output is built in contiguous buffer and written to the stream at once
      *
      * @param os reference to stream where to print data
      */
     void write(std::ostream& os) const {
+        const auto buffer = dump();
+        os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+
+    /**
+     * @brief Serializes data appending it to the end of provided buffer.
+     * Buffer can be cleared and reused between calls so its capacity
+     * is allocated only once
+     *
+     * @param out buffer where to print data
+     */
+    void write(std::string& out) const {
         auto value_visitor = detail::overload(
-            [](null_t val) {},
-            [&os](bool_t val) { os << val; },
-            [&os](int_t val) { os << val; },
-            [&os](float_t val) { os << detail::stripZeroes(val); },
-            [&os](const string_t& val) { os << std::quoted(val); });
+            [](null_t) {},
+            [&out](bool_t val) { out.append(val ? "true" : "false"); },
+            [&out](int_t val) {
+                std::array<char_t, std::numeric_limits<int_t>::digits10 + 3>
+                    buffer;
+                const auto end = std::to_chars(
+                    buffer.data(), buffer.data() + buffer.size(), val).ptr;
+                out.append(buffer.data(), end);
+            },
+            [&out](float_t val) { detail::_appendFloatingPoint(out, val); },
+            [&out](const string_t& val) { detail::_appendQuoted(out, val); });
 
         for (auto&& section : _sections) {
-            os << '[' << section.first << "]\n";
+            out.push_back('[');
+            out.append(section.first);
+            out.append("]\n");
 
             for (auto&& keyValue : section.second) {
-                os << keyValue.first << " = ";
+                out.append(keyValue.first);
+                out.append(" = ");
                 std::visit(value_visitor, keyValue.second);
-
-                os << '\n';
+                out.push_back('\n');
             }
-            os << std::endl;
+            out.push_back('\n');
         }
     }
 
@@ -416,656 +1919,463 @@ class Ini {
      * @return std::string string representation of internal data
      */
     std::string dump() const {
-        std::stringstream ss;
-        write(ss);
-        return ss.str();
+        std::string result;
+        write(result);
+        return result;
+    }
+
+    /**
+     * @brief Saves binary snapshot of current data, which can be mapped by
+     * IniSnapshot or loaded by fromSnapshot() without parsing.
+     * Size and modification time of source are recorded, so snapshot is
+     * considered stale as soon as source changes, they are taken when this
+     * function is called, thus source must not change since it was read.
+     * File is written next to the snapshot under unique temporary name and
+     * renamed over it, so readers never observe partially written snapshot
+     * and concurrent writers never share the file
+     * @note throws std::filesystem::filesystem_error if source does not
+     * exist or snapshot can not be written
+     *
+     * @param snapshot path where to save snapshot
+     * @param source path to the text file data was read from
+     */
+    void writeSnapshot(const std::filesystem::path& snapshot,
+                       const std::filesystem::path& source) const {
+        _writeSnapshot(snapshot, detail::_iniSourceStamp(source));
     }
 
-    // TODO test me
+    /**
+     * @brief Copies all values of snapshot, nothing is parsed
+     * @see IniSnapshot
+     *
+     * @param snapshot snapshot to read from
+     */
+    void read(const IniSnapshot& snapshot) {
+        if constexpr (not _stableReferences) _slots.reset();
+        _forgetSource();
+
+        container_t* section = nullptr;
+
+        snapshot.visit(detail::overload(
+            [&](std::string_view name) { section = &_sections[key_t(name)]; },
+            [&](std::string_view, std::string_view key,
+                const IniSnapshot::value_t& value) {
+                (*section)[key_t(key)] = std::visit(
+                    detail::overload(
+                        [](ini::null_t) -> value_t { return null_t{}; },
+                        [](std::string_view val) -> value_t {
+                            return string_t(val);
+                        },
+                        [](auto val) -> value_t { return val; }),
+                    value);
+            }));
+    }
 
     /**
-     * @brief Explicit call to parsing function
+     * @brief Explicit call to parsing function.
+     * Whole stream is read into single buffer which is then parsed
+     * by read(std::string_view)
      *
      * @param is reference to stream from which to parse data
      */
     void read(std::istream& is) {
-        // giving stuff self explanatory names
-        static auto isLower = [](char_t ch) -> bool {
-            return ch >= 'a' and ch <= 'z';
-        };
-        static auto isUpper = [](char_t ch) -> bool {
-            return ch >= 'A' and ch <= 'Z';
-        };
-        static auto isAlpha = [](char_t ch) -> bool {
-            return isLower(ch) or isUpper(ch);
-        };
-        static auto isBinDigit = [](char_t ch) -> bool {
-            return ch == '1' or ch == '0';
-        };
-        static auto isOctDigit = [](char_t ch) -> bool {
-            return ch >= '0' and ch <= '7';
-        };
-        static auto isDigit = [](char_t ch) -> bool {
-            return ch >= '0' and ch <= '9';
-        };
-        static auto isHexDigit = [](char_t ch) -> bool {
-            return isDigit(ch) or
-                   (ch >= 'A' and ch <= 'F') or
-                   (ch >= 'a' and ch <= 'f');
-        };
-        static auto isComment = [](char_t ch) -> bool { return ch == ';' or
-                                                               ch == '#'; };
-        static auto isSpace = [](char_t ch) -> bool { return ch == ' ' or
-                                                             ch == '\t'; };
-        static auto isExponent = [](char_t ch) -> bool {
-            return ch == 'E' or ch == 'e';
-        };
-        static auto isEof = [](char_t ch) -> bool {
-            return ch == std::char_traits<char_t>::eof();
-        };
-
-        static auto isSectionOpen = [](char_t ch) -> bool { return ch == '['; };
-        static auto isSectionClose = [](char_t ch) -> bool { return ch == ']'; };
-        static auto isQuote = [](char_t ch) -> bool { return ch == '"'; };
-        static auto isDot = [](char_t ch) -> bool { return ch == '.'; };
-        static auto isMinus = [](char_t ch) -> bool { return ch == '-'; };
-        static auto isPlus = [](char_t ch) -> bool { return ch == '+'; };
-        static auto isUnderscore = [](char_t ch) -> bool { return ch == '_'; };
-        static auto isSingleQuote = [](char_t ch) -> bool { return ch == '\''; };
-        static auto isEndline = [](char_t ch) -> bool { return ch == '\n'; };
-        static auto isBackslash = [](char_t ch) -> bool { return ch == '\\'; };
-        static auto isEquals = [](char_t ch) -> bool { return ch == '='; };
-
-        static auto isTrueStart = [](char_t ch) -> bool { return ch == 't'; };
-        static auto isFalseStart = [](char_t ch) -> bool { return ch == 'f'; };
-        static auto isNullStart = [](char_t ch) -> bool { return ch == 'n'; };
-
-        static auto isHexStart = [](char_t ch, char_t next) -> bool {
-            return ch == '0' and next == 'x';
-        };
-        static auto isBinStart = [](char_t ch, char_t next) -> bool {
-            return ch == '0' and next == 'b';
-        };
-        static auto isOctStart = [](char_t ch, char_t next) -> bool {
-            return ch == '0' and next == 'o';
-        };
-
-        // all possible states of state machine
-        enum State {
-            MaybeEmptyLine,
-            ConsumeTrailingSpaces,
-            KeyValueDelimiter,
-            ValueStart,
-            Start,
-
-            Section,
-            Comment,
-            Key,
-            String,
-            FloatingPoint,
-            Integer,
-            BinInteger,
-            OctInteger,
-            HexInteger,
-            Boolean,
-            NullValue,
-        };
-
-        // all data are in one struct closure
-        // therefore we can pass reference to it
-        // and get all current variables at once
-        struct {
-            State state = Start;
-            string_t section = "";
-            string_t key = "";
-            string_t value = "";
-            size_t line = 1;
-
-            void resetSection() {
-                section.clear();
-            }
-
-            void resetKeyValue() {
-                key.clear();
-                value.clear();
-            }
-
-        } current;
-
-        // desperate try to limit amount of repetitive code inside
-        // of state handling routines
-        static auto regularTokenEndHandle = [](char_t ch, auto& current,
-                                               auto finalize) -> bool {
-            if (isSpace(ch)) {
-                finalize(current);
-                current.resetKeyValue();
-                current.state = ConsumeTrailingSpaces;
-                return true;
-            }
-
-            if (isComment(ch)) {
-                finalize(current);
-                current.resetKeyValue();
-                current.state = Comment;
-                return true;
-            }
+        string_t buffer;
+        std::array<char_t, 4096> chunk;
 
-            if (isEndline(ch)) {
-                finalize(current);
-                current.resetKeyValue();
-                current.state = MaybeEmptyLine;
-                return true;
-            }
+        while (is.read(chunk.data(), chunk.size()) or is.gcount()) {
+            buffer.append(chunk.data(), static_cast<size_t>(is.gcount()));
+        }
 
-            if (isEof(ch)) {
-                finalize(current);
-                current.resetKeyValue();
-                return true;
-            }
+        read(std::string_view(buffer));
+    }
 
-            return false;
-        };
+    /**
+     * @brief Maps file into memory and parses it in place
+     * @note throws std::system_error if file can not be opened
+     *
+     * @param path path to the file to parse
+     */
+    void readFile(const std::filesystem::path& path) {
+        const my::MappedFile file(path);
+        read(file.view());
+    }
 
-        for (;;) {
-            // extract char from stream
-            const auto ch = is.get();
-
-            // counting lines and chars to print more info in errors
-            if (isEndline(ch)) ++current.line;
-
-            // state machine starts
-            switch (current.state) {
-                // If we are only starting there is three possible cases
-                // we either got empty line with spaces, comment or section
-                // in any other case we throw
-                case Start: {
-                    if (isEndline(ch) or isSpace(ch)) {
-                        break;
-                    }
-
-                    if (isComment(ch)) {
-                        current.state = Comment;
-                        break;
-                    }
-
-                    if (isSectionOpen(ch)) {
-                        current.state = Section;
-                        break;
-                    }
-
-                    throw IniParseException("File must start from section:{}",
-                                            current.line);
-                }
+    /**
+     * @brief Explicit call to parsing function.
+     * Consumes events of my::parseIni, keys and values are kept as
+     * views into data and only copied when stored into the section
+     *
+     * @param data buffer to parse
+     */
+    void read(std::string_view data) {
+        if constexpr (not _stableReferences) _slots.reset();
+        _forgetSource();
+
+        // section currently being filled, looked up once per declaration
+        container_t* section = nullptr;
+
+        my::parseIni(data, detail::overload(
+            [&](const ini::SectionEvent& event) {
+                section = &_sections[key_t(event.name)];
+            },
+            [&](const ini::ValueEvent& event) {
+                (*section)[key_t(event.key)] = _decode(event);
+            }));
+    }
 
-                // If open section token was read
-                // we reading all alpha-numeric chars until it's closed
-                // In case of empty section or non alpha-numeric char we throw
-                case Section: {
-                    if (isSectionClose(ch)) {
-                        if (current.section.empty()) {
-                            throw IniParseException(
-                                "Section name must not be empty:{}",
-                                current.line);
-                        }
-                        _sections[current.section];
-                        current.state = ConsumeTrailingSpaces;
-                        break;
-                    }
-
-                    if (not(isAlpha(ch) or isDigit(ch))) {
-                        throw IniParseException(
-                            "Section name must contain only "
-                            "alpha numeric chars:{}",
-                            current.line);
-                    }
-
-                    current.section.push_back(ch);
-                    break;
-                }
+    /**
+     * @brief Makes contents equal to data, touching only what changed.
+     * Data is split into sections by lightweight scan and source of each
+     * one is hashed and compared with the one from previous reload(),
+     * sections with the same hash and bytes are skipped without
+     * tokenizing them (copy of data is kept for that comparison),
+     * the rest are parsed and patched in place so
+     * references to unchanged values stay valid (for node based maps).
+     * Sections absent in data are removed.
+     * @note first reload() after construction, read() or merge() has nothing
+     * to compare with, so every section is parsed, yet only real differences
+     * are reported. Modifications made through accessors are not tracked,
+     * section which source did not change keeps them.
+     * Throws IniParseException before anything is modified if data is
+     * malformed
+     *
+     * #Example:
+     * my::MappedFile file("config.ini");
+     * for (auto&& [section, key] : config.reload(file).changed) { ... }
+     *
+     * @param data buffer to parse
+     * @return diff_t added, removed and changed keys
+     */
+    diff_t reload(std::string_view data) {
+        diff_t diff;
+
+        const auto sourceHash = std::hash<std::string_view>{}(data);
+        if (_sourceHash == sourceHash and _source == data) return diff;
+
+        const auto chunks = detail::_splitIniSections(data);
+
+        // same section may be declared several times, its hash then covers
+        // all of its declarations in order, text before first section is
+        // kept under empty name
+        Map<key_t, _source_t> sources;
+        for (auto&& chunk : chunks) {
+            auto& source = sources[key_t(chunk.name)];
+            source.hash ^= std::hash<std::string_view>{}(chunk.text) +
+                           0x9e3779b9 + (source.hash << 6) +
+                           (source.hash >> 2);
+            source.spans.emplace_back(
+                static_cast<size_t>(chunk.text.data() - data.data()),
+                chunk.text.size());
+        }
 
-                // Each next line potentially can be empty or contain spaces
-                // we need to consume it and wait until section token or any
-                // alpha-numeric char appears. In case we received non
-                // alpha-numeric char we throw same error as if we received it in
-                // the key state
-                case MaybeEmptyLine: {
-                    if (isEndline(ch) or
-                        isSpace(ch) or
-                        isEof(ch)) break;
-
-                    if (isSectionOpen(ch)) {
-                        current.resetSection();
-                        current.state = Section;
-                        break;
-                    }
-
-                    if (isComment(ch)) {
-                        current.state = Comment;
-                        break;
-                    }
-
-                    if (not(isAlpha(ch) or isDigit(ch) or isUnderscore(ch))) {
-                        throw IniParseException(
-                            "Key must contain only alpha "
-                            "numeric chars:{}",
-                            current.line);
-                    }
-
-                    current.key.push_back(ch);
-                    current.state = Key;
-                    break;
+        Map<key_t, container_t> parsed;
+        try {
+            for (auto&& chunk : chunks) {
+                const key_t name(chunk.name);
+                auto old = _sourceSections.find(name);
+                if (old != _sourceSections.end() and
+                    _sameSource(old->second, sources.at(name), data) and
+                    (name.empty() or _sections.contains(name))) {
+                    continue;
                 }
 
-                // After each value or section we can receive
-                // trailing spaces, consume it and throw in case there is
-                // something that is not a whitespace, endline or comment
-                case ConsumeTrailingSpaces: {
-                    if (isSpace(ch) or isEof(ch)) break;
-                    if (isComment(ch)) {
-                        current.state = Comment;
-                        break;
-                    }
-                    if (isEndline(ch)) {
-                        current.state = MaybeEmptyLine;
-                        break;
-                    }
-                    throw IniParseException(
-                        "Only trailing spaces, comment or "
-                        "newline is required after value:{}",
-                        current.line);
+                if (name.empty()) {
+                    my::parseIni(chunk.text, [](const auto&) {});
+                    continue;
                 }
 
-                // Simply consume all chars until endline or eof
-                case Comment: {
-                    if (isEof(ch)) break;
-                    if (isEndline(ch)) {
-                        current.state = MaybeEmptyLine;
-                    }
-                    break;
-                }
+                auto& section = parsed[name];
+                my::parseIni(chunk.text, [&](const ini::ValueEvent& event) {
+                    section[key_t(event.key)] = _decode(event);
+                });
+            }
+        } catch (const IniParseException&) {
+            // chunk reports lines relative to itself, whole data is
+            // parsed again to report actual position of the error
+            my::parseIni(data, [](const auto&) {});
+            throw;
+        }
 
-                // If we received alpha-numeric char after section or empty line
-                // we end up here
-                // Whitespace char will move us to consuming state of spaces
-                // between last key char and equals sign
-                // Equals sign will move us directly to value state
-                case Key: {
-                    if (isComment(ch)) {
-                        throw IniParseException(
-                            "Comments is prohibited inside "
-                            "of key declaration:{}",
-                            current.line);
-                    }
-
-                    if (isSpace(ch)) {
-                        if (current.key.empty()) {
-                            throw IniParseException(
-                                "Key must not be empty:{}",
-                                current.line);
-                        }
-                        current.state = KeyValueDelimiter;
-                        break;
-                    }
-
-                    if (isEquals(ch)) {
-                        if (current.key.empty()) {
-                            throw IniParseException(
-                                "Key must not be empty:{}",
-                                current.line);
-                        }
-                        current.state = ValueStart;
-                        break;
-                    }
-
-                    if (not(isAlpha(ch) or isDigit(ch) or isUnderscore(ch))) {
-                        throw IniParseException(
-                            "Key must contain only alpha "
-                            "numeric chars:{}",
-                            current.line);
-                    }
-
-                    current.key.push_back(ch);
-                    break;
-                }
+        // absent sections are removed in single pass, so flat maps
+        // shift their entries once, not once per section
+        using std::erase_if;
+        erase_if(_sections, [&](const auto& section) {
+            if (not section.first.empty() and
+                sources.contains(section.first)) {
+                return false;
+            }
+            for (auto&& keyValue : section.second) {
+                diff.removed.emplace_back(section.first, keyValue.first);
+            }
+            return true;
+        });
 
-                // Consume all spaces until equals sign is found
-                // throw if any other char appears
-                case KeyValueDelimiter: {
-                    if (isSpace(ch)) break;
+        for (auto&& section : parsed) {
+            _patch(section.first, _sections[section.first],
+                   std::move(section.second), diff);
+        }
 
-                    if (isEquals(ch)) {
-                        current.state = ValueStart;
-                        break;
-                    }
+        if (not _stableReferences or not diff.removed.empty()) {
+            _slots.reset();
+        }
 
-                    throw IniParseException(
-                        "Key must not contain spaces:{}",
-                        current.line);
-                }
+        _sourceSections = std::move(sources);
+        _sourceHash = sourceHash;
+        _source.assign(data);
 
-                // Here we determine what value possibly will be
-                // We consume all front spaces until meaningful char appears
-                // If we reached endline or comment we terminating and setting
-                // value to null
-                // If it is quote then we go to string value state
-                // If it is hex, bin or oct starting sequence we go to
-                // appropriate integer state
-                // If it is just a digit or leading plus or minus sign we go to
-                // state simple integer state (with possibility that it is float)
-                // If it is leading dot we go to float state
-                // If it is first char of null, true or false token we go to
-                // respective state
-                // Else we throw
-                case ValueStart: {
-                    if (isSpace(ch)) break;
-
-                    if (regularTokenEndHandle(ch, current, [this](auto& curr) {
-                            _sections[curr.section][curr.key] = null_t{};
-                        })) break;
-
-                    if (isQuote(ch)) {
-                        current.state = String;
-                        break;
-                    }
-
-                    if (isHexStart(ch, is.peek())) {
-                        is.get();
-                        current.state = HexInteger;
-                        break;
-                    }
-
-                    if (isBinStart(ch, is.peek())) {
-                        is.get();
-                        current.state = BinInteger;
-                        break;
-                    }
-
-                    if (isOctStart(ch, is.peek())) {
-                        is.get();
-                        current.state = OctInteger;
-                        break;
-                    }
-
-                    if (isDigit(ch) or isMinus(ch) or isPlus(ch)) {
-                        current.value.push_back(ch);
-                        current.state = Integer;
-                        break;
-                    }
-
-                    if (isDot(ch)) {
-                        current.value.push_back(ch);
-                        current.state = FloatingPoint;
-                        break;
-                    }
-
-                    if (isTrueStart(ch) or isFalseStart(ch)) {
-                        current.value.push_back(ch);
-                        current.state = Boolean;
-                        break;
-                    }
-
-                    if (isNullStart(ch)) {
-                        current.value.push_back(ch);
-                        current.state = NullValue;
-                        break;
-                    }
-
-                    throw IniParseException(
-                        "Value must be either quoted string, number, "
-                        "boolean, or null (empty line):{}",
-                        current.line);
-                }
+        return diff;
+    }
 
-                // Parsing string as-is if we receive backslash we lookahead
-                // if there is quote and insert it in this case
-                // If we reached another quote without backslash we terminating
-                // and consuming trailing spaces (or comment)
-                case String: {
-                    if (isQuote(ch)) {
-                        _sections[current.section][current.key] = current.value;
-                        current.resetKeyValue();
-                        current.state = ConsumeTrailingSpaces;
-                        break;
-                    }
-
-                    if (isBackslash(ch) and isQuote(is.peek())) {
-                        current.value.push_back(is.get());
-                        break;
-                    }
-
-                    current.value.push_back(ch);
-                    break;
-                }
+   private:
+    // stamp is size and modification time of source the data was read from
+    void _writeSnapshot(const std::filesystem::path& snapshot,
+                        std::pair<uint64_t, int64_t> stamp) const {
+        using header_t = detail::_IniSnapshotHeader;
+        using section_t = detail::_IniSnapshotSection;
+        using entry_t = detail::_IniSnapshotEntry;
+
+        const auto [sourceSize, sourceTime] = stamp;
+
+        // iterators, not addresses, flat maps yield proxies to entries
+        std::vector<typename decltype(_sections)::const_iterator> sections;
+        size_t entryCount = 0;
+        for (auto it = _sections.cbegin(); it != _sections.cend(); ++it) {
+            sections.push_back(it);
+            entryCount += it->second.size();
+        }
+        std::ranges::sort(sections, {}, [](auto section) -> const key_t& {
+            return section->first;
+        });
+
+        std::vector<section_t> sectionTable;
+        std::vector<entry_t> entryTable;
+        std::string strings;
+        sectionTable.reserve(sections.size());
+        entryTable.reserve(entryCount);
+
+        auto store = [&strings](std::string_view string) {
+            detail::_IniSnapshotString result{strings.size(), string.size()};
+            strings.append(string);
+            return result;
+        };
 
-                // We receive all supported chars even if it is prohibited,
-                // Then when we reach the end of number we parse it with
-                // standard operator that will handle all errors for us
-                // It would be really tough to prevent repetitive exponent or
-                // plus/minus signs using separate states
-                case FloatingPoint: {
-                    if (regularTokenEndHandle(ch, current, [this](auto& curr) {
-                            std::istringstream ss(curr.value);
-                            float_t result;
-                            ss >> result;
-                            if (not ss) {
-                                throw IniParseException(
-                                    "Value \"{}\" is invalid floating "
-                                    "point value:{}",
-                                    curr.value, curr.line);
-                            }
-                            _sections[curr.section][curr.key] = result;
-                        })) break;
-
-                    if (isUnderscore(ch) or isSingleQuote(ch)) {
-                        break;
-                    }
-
-                    if (not(isDigit(ch) or isExponent(ch) or
-                            isPlus(ch) or isMinus(ch))) {
-                        throw IniParseException(
-                            "Invalid symbol \"{}\" in floating point "
-                            "number:{}",
-                            ch, current.line);
-                    }
-
-                    current.value.push_back(ch);
-                    break;
-                }
+        std::vector<typename container_t::const_iterator> keys;
+        for (auto section : sections) {
+            sectionTable.push_back({store(section->first), entryTable.size(),
+                                    section->second.size()});
 
-                // Read all digits skip all separators if dot is found then
-                // it is float go to appropriate state
-                // If any inappropriate symbol found - throw
-                case Integer: {
-                    if (regularTokenEndHandle(ch, current, [this](auto& curr) {
-                            std::istringstream ss(curr.value);
-                            int_t result;
-                            ss >> result;
-                            if (not ss) {
-                                throw IniParseException(
-                                    "Value \"{}\" is invalid integral "
-                                    "value:{}",
-                                    curr.value, curr.line);
-                            }
-                            _sections[curr.section][curr.key] = result;
-                        })) break;
-
-                    if (isUnderscore(ch) or isSingleQuote(ch)) {
-                        break;
-                    }
-
-                    if (isDot(ch)) {
-                        current.value.push_back(ch);
-                        current.state = FloatingPoint;
-                        break;
-                    }
-
-                    if (not isDigit(ch)) {
-                        throw IniParseException(
-                            "Integer must only contain digits "
-                            "in range [0 - 9]:{}",
-                            current.line);
-                    }
-
-                    current.value.push_back(ch);
-                    break;
-                }
+            keys.clear();
+            const auto& values = section->second;
+            for (auto it = values.cbegin(); it != values.cend(); ++it) {
+                keys.push_back(it);
+            }
+            std::ranges::sort(keys, {}, [](auto keyValue) -> const key_t& {
+                return keyValue->first;
+            });
+
+            for (auto keyValue : keys) {
+                entry_t entry{store(keyValue->first),
+                              keyValue->second.index(), 0, 0};
+                std::visit(detail::overload(
+                               [](null_t) {},
+                               [&](bool_t val) { entry.value = val; },
+                               [&](float_t val) {
+                                   entry.value = std::bit_cast<uint64_t>(val);
+                               },
+                               [&](int_t val) {
+                                   entry.value = static_cast<uint64_t>(val);
+                               },
+                               [&](const string_t& val) {
+                                   const auto string = store(val);
+                                   entry.value = string.offset;
+                                   entry.size = string.size;
+                               }),
+                           keyValue->second);
+                entryTable.push_back(entry);
+            }
+        }
 
-                // bin, hex, oct states are basically all the same
-                // skip separators, throw if not appropriate digit
-                // parse using standard io method
-                case BinInteger: {
-                    if (regularTokenEndHandle(ch, current, [this](auto& curr) {
-                            std::bitset<32> tmp(curr.value);
-                            _sections[curr.section][curr.key] = tmp.to_ulong();
-                        })) break;
-
-                    if (isUnderscore(ch) or isSingleQuote(ch)) {
-                        break;
-                    }
-
-                    if (not isBinDigit(ch)) {
-                        throw IniParseException(
-                            "Binary integer must only contain "
-                            "0 and 1 digits:{}",
-                            current.line);
-                    }
-
-                    current.value.push_back(ch);
-                    break;
-                }
+        const header_t header{
+            header_t::signature, header_t::currentVersion,
+            header_t::nativeOrder, sourceSize, sourceTime,
+            sectionTable.size(), entryTable.size(), strings.size()};
+
+        const auto temporary = detail::_iniTemporaryPath(snapshot);
+        try {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(sectionTable.data()),
+                      sectionTable.size() * sizeof(section_t));
+            out.write(reinterpret_cast<const char*>(entryTable.data()),
+                      entryTable.size() * sizeof(entry_t));
+            out.write(strings.data(), strings.size());
+            out.close();
+
+            if (not out) {
+                throw std::filesystem::filesystem_error(
+                    "Ini::writeSnapshot", temporary,
+                    std::make_error_code(std::errc::io_error));
+            }
+            std::filesystem::rename(temporary, snapshot);
+        } catch (...) {
+            std::error_code ec;
+            std::filesystem::remove(temporary, ec);
+            throw;
+        }
+    }
 
-                case OctInteger: {
-                    if (regularTokenEndHandle(ch, current, [this](auto& curr) {
-                            std::istringstream ss(curr.value);
-                            int_t result;
-                            ss >> std::oct >> result;
-                            if (not ss) {
-                                throw IniParseException(
-                                    "Value \"{}\" is invalid octal value:{}",
-                                    curr.value, curr.line);
-                            }
-                            _sections[curr.section][curr.key] = result;
-                        })) break;
-
-                    if (isUnderscore(ch) or isSingleQuote(ch)) {
-                        break;
-                    }
-
-                    if (not isOctDigit(ch)) {
-                        throw IniParseException(
-                            "Octal integer must only contain "
-                            "digits in range [0 - 7]:{}",
-                            current.line);
-                    }
-
-                    current.value.push_back(ch);
-                    break;
-                }
+    static value_t _decode(const ini::ValueEvent& event) {
+        switch (event.type) {
+            using enum ini::ValueType;
+            case Null: return null_t{};
+            case Boolean: return event.boolean();
+            case FloatingPoint: return event.floatingPoint();
+            case String: return event.string();
+            default: return event.integer();
+        }
+    }
 
-                case HexInteger: {
-                    if (regularTokenEndHandle(ch, current, [this](auto& curr) {
-                            std::istringstream ss(curr.value);
-                            int_t result;
-                            ss >> std::hex >> result;
-                            if (not ss) {
-                                throw IniParseException(
-                                    "Value \"{}\" is invalid hexadecimal value:{}",
-                                    curr.value, curr.line);
-                            }
-                            _sections[curr.section][curr.key] = result;
-                        })) break;
-
-                    if (isUnderscore(ch) or isSingleQuote(ch)) {
-                        break;
-                    }
-
-                    if (not isHexDigit(ch)) {
-                        throw IniParseException(
-                            "Hexadecimal integer must only contain digits "
-                            "in range [0 - 9] and chars in range [A - F]:{}",
-                            current.line);
-                    }
-
-                    current.value.push_back(ch);
-                    break;
-                }
+    // brings current section to fresh one recording each difference
+    static void _patch(const key_t& name, container_t& current,
+                       container_t&& fresh, diff_t& diff) {
+        using std::erase_if;
+        erase_if(current, [&](const auto& keyValue) {
+            if (fresh.contains(keyValue.first)) return false;
+            diff.removed.emplace_back(name, keyValue.first);
+            return true;
+        });
+
+        for (auto&& keyValue : fresh) {
+            auto [it, inserted] = current.try_emplace(keyValue.first);
+            if (inserted) {
+                it->second = std::move(keyValue.second);
+                diff.added.emplace_back(name, keyValue.first);
+            } else if (it->second != keyValue.second) {
+                it->second = std::move(keyValue.second);
+                diff.changed.emplace_back(name, keyValue.first);
+            }
+        }
+    }
 
-                // boolean and null are keywords so we parse them in a similar
-                // fashion if end reached check if value read is appropriate
-                // keyword insert parsed value throw otherwise
-                case Boolean: {
-                    if (regularTokenEndHandle(ch, current, [this](auto& curr) {
-                            std::istringstream ss(curr.value);
-                            bool_t result;
-                            ss >> std::boolalpha >> result;
-                            if (not ss) {
-                                throw IniParseException(
-                                    "Value \"{}\" is invalid boolean value:{}",
-                                    curr.value, curr.line);
-                            }
-                            _sections[curr.section][curr.key] = result;
-                        })) break;
-
-                    current.value.push_back(ch);
-                    break;
+    // moves values of source into target, new ones are spliced when
+    // possible, source is left empty or with moved from values
+    static void _splice(container_t& target, container_t& source) {
+        if constexpr (_stableReferences) {
+            for (auto it = source.begin(); it != source.end();) {
+                auto found = target.find(it->first);
+                if (found == target.end()) {
+                    target.insert(source.extract(it++));
+                    continue;
                 }
+                found->second = std::move(it->second);
+                ++it;
+            }
+        } else {
+            for (auto&& keyValue : _release(source)) {
+                target.insert_or_assign(std::move(keyValue.first),
+                                        std::move(keyValue.second));
+            }
+        }
+    }
 
-                case NullValue: {
-                    if (regularTokenEndHandle(ch, current, [this](auto& curr) {
-                            if (curr.value != "null") {
-                                throw IniParseException(
-                                    "Value \"{}\" is invalid null value:{}",
-                                    curr.value, curr.line);
-                            }
-
-                            _sections[curr.section][curr.key] = null_t{};
-                        })) break;
+    // entries to move from, flat maps give their storage away so keys are
+    // moved as well, other maps keep keys const and they are copied
+    template <class M>
+    static decltype(auto) _release(M& map) {
+        if constexpr (requires { std::move(map).extract(); }) {
+            return std::move(map).extract();
+        } else {
+            return (map);
+        }
+    }
 
-                    current.value.push_back(ch);
-                    break;
-                }
+    // hash and offsets of each declaration of section within _source
+    struct _source_t {
+        size_t hash = 0;
+        std::vector<std::pair<size_t, size_t>> spans;
+    };
+
+    // hash alone may collide, so equal hashes are confirmed by comparing
+    // declarations with their text kept from previous reload()
+    bool _sameSource(const _source_t& old, const _source_t& fresh,
+                     std::string_view data) const {
+        if (old.hash != fresh.hash or old.spans.size() != fresh.spans.size()) {
+            return false;
+        }
+        const std::string_view source = _source;
+        for (size_t i = 0; i < old.spans.size(); ++i) {
+            const auto [oldOffset, oldSize] = old.spans[i];
+            const auto [offset, size] = fresh.spans[i];
+            if (source.substr(oldOffset, oldSize) != data.substr(offset, size)) {
+                return false;
             }
-
-            // if reached the end or got error break from the loop
-            // we need to process eof before leaving so each state can
-            // finalize normally
-            if (is.eof() or is.fail()) break;
         }
+        return true;
     }
 
-    /**
-     * @brief Explicit call to parsing function
-     *
-     * @param data string to parse
-     */
-    void read(const std::string& data) {
-        std::stringstream ss(data);
-        read(ss);
+    void _forgetSource() noexcept {
+        _sourceSections.clear();
+        _sourceHash.reset();
+        _source.clear();
     }
 
-   private:
-    Map<key_t, container_t> _sections;
-};
+    // node based maps keep references valid on insertion
+    static constexpr bool _stableReferences =
+        requires { typename container_t::node_type; };
+
+    // find value by name without constructing key when map allows it
+    template <class M>
+    static auto& _at(M& map, std::string_view name) {
+        if constexpr (requires { map.find(name); }) {
+            auto it = map.find(name);
+            if (it == map.end()) throw std::out_of_range("Ini::at");
+            return it->second;
+        } else {
+            return map.at(key_t(name));
+        }
+    }
 
-namespace ini {
+    Map<key_t, container_t> _sections;
+    detail::_IniSlots<value_t> _slots;
 
-using bool_t = bool;
-using float_t = double;
-using int_t = int64_t;
-using string_t = std::string;
-struct null_t {};
+    // section sources and whole data seen by last reload()
+    Map<key_t, _source_t> _sourceSections;
+    std::optional<size_t> _sourceHash;
+    std::string _source;
+};
 
-}  // namespace ini
+/**
+ * @brief Result of Ini::fromFiles()
+ *
+ */
+template <template <class, class> class Map>
+struct Ini<Map>::loaded_t {
+    Ini ini;
+    std::vector<std::chrono::nanoseconds> timings;
+};
 
 inline namespace literals {
 
 inline namespace ini_literals {
 
-auto operator"" _ini(const char* data, size_t) {
-    Ini<std::map> result(data);
+auto operator"" _ini(const char* data, size_t size) {
+    Ini<std::map> result(std::string_view(data, size));
     return result;
 }
 
+/**
+ * @brief Creates compile time handle from "Section.key" literal
+ * @see IniKey
+ */
+consteval IniKey operator"" _key(const char* data, size_t size) {
+    const std::string_view name(data, size);
+    const auto dot = name.find('.');
+    if (dot == std::string_view::npos) {
+        throw "IniKey literal must have form \"Section.key\"";
+    }
+    return IniKey(name.substr(0, dot), name.substr(dot + 1));
+}
+
 }  // namespace ini_literals
 
 }  // namespace literals
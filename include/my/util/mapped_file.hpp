@@ -0,0 +1,167 @@
+#pragma once
+#ifndef MY_MAPPED_FILE_HPP
+#define MY_MAPPED_FILE_HPP
+
+#include <cerrno>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <my/util/win_defs.hpp>
+#define MY_MAPPED_FILE_WIN32 1
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace my {
+
+/**
+ * @brief Read-only memory mapping of the whole file.
+ * Contents are exposed as contiguous std::string_view which stays valid
+ * for the lifetime of the object, so parsers can hand out views into it
+ * instead of copying.
+ *
+ * #Example:
+ * my::MappedFile file("config.ini");
+ * std::string_view text = file.view();
+ *
+ * @note empty files are not mapped at all, view() returns empty view then
+ */
+class MappedFile {
+   public:
+    constexpr MappedFile() noexcept = default;
+
+    /**
+     * @brief Maps file located at path
+     * @note throws std::system_error if file can not be opened or mapped
+     *
+     * @param path path to file
+     */
+    explicit MappedFile(const std::filesystem::path& path) { _open(path); }
+
+    MappedFile(MappedFile&& other) noexcept
+        : _data(std::exchange(other._data, nullptr)),
+          _size(std::exchange(other._size, 0)) {
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            _close();
+            _data = std::exchange(other._data, nullptr);
+            _size = std::exchange(other._size, 0);
+        }
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() { _close(); }
+
+    /**
+     * @brief View of the whole mapped region
+     */
+    constexpr std::string_view view() const noexcept { return {_data, _size}; }
+    constexpr const char* data() const noexcept { return _data; }
+    constexpr size_t size() const noexcept { return _size; }
+    constexpr bool empty() const noexcept { return _size == 0; }
+
+    constexpr operator std::string_view() const noexcept { return view(); }
+
+   private:
+#if defined(MY_MAPPED_FILE_WIN32)
+    void _open(const std::filesystem::path& path) {
+        auto fail = [](const char* what) {
+            throw std::system_error(static_cast<int>(GetLastError()),
+                                    std::system_category(), what);
+        };
+
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                                  nullptr, OPEN_EXISTING,
+                                  FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) fail("CreateFileW");
+
+        LARGE_INTEGER size;
+        if (not GetFileSizeEx(file, &size)) {
+            CloseHandle(file);
+            fail("GetFileSizeEx");
+        }
+
+        _size = static_cast<size_t>(size.QuadPart);
+        if (_size == 0) {
+            CloseHandle(file);
+            return;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY,
+                                            0, 0, nullptr);
+        CloseHandle(file);
+        if (not mapping) fail("CreateFileMappingW");
+
+        _data = static_cast<const char*>(
+            MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+        if (not _data) {
+            _size = 0;
+            fail("MapViewOfFile");
+        }
+    }
+
+    void _close() noexcept {
+        if (_data) UnmapViewOfFile(_data);
+        _data = nullptr;
+        _size = 0;
+    }
+#else
+    void _open(const std::filesystem::path& path) {
+        auto fail = [](int error, const char* what) {
+            throw std::system_error(error, std::generic_category(), what);
+        };
+
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) fail(errno, "open");
+
+        struct stat st {};
+        if (::fstat(fd, &st) == -1) {
+            const int error = errno;
+            ::close(fd);
+            fail(error, "fstat");
+        }
+
+        _size = static_cast<size_t>(st.st_size);
+        if (_size == 0) {
+            ::close(fd);
+            return;
+        }
+
+        void* data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        const int error = errno;
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            _size = 0;
+            fail(error, "mmap");
+        }
+
+        ::madvise(data, _size, MADV_SEQUENTIAL);
+        _data = static_cast<const char*>(data);
+    }
+
+    void _close() noexcept {
+        if (_data) ::munmap(const_cast<char*>(_data), _size);
+        _data = nullptr;
+        _size = 0;
+    }
+#endif
+
+    const char* _data = nullptr;
+    size_t _size = 0;
+};
+
+}  // namespace my
+
+#endif  // MY_MAPPED_FILE_HPP
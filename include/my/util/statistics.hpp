@@ -121,13 +121,40 @@ constexpr auto median(It b, It e) {
 
     if (b == e) return value_t{};
 
-    float size = std::distance(b, e) / 2.f;
-    auto lhs = *(b + std::ceil(size));
-    auto rhs = *(b + std::floor(size));
+    const auto size = std::distance(b, e);
+    auto lhs = *(b + (size - 1) / 2);
+    auto rhs = *(b + size / 2);
 
     return (lhs + rhs) / static_cast<value_t>(2);
 }
 
+/**
+ * @brief Finds p-th percentile of numeric range, interpolating linearly
+ * between the closest ranks, requires underlying container to be sorted
+ *
+ * @tparam It Random access iterator
+ * @param b begin of range
+ * @param e end of range
+ * @param p percentile in range [0, 100]
+ * @return auto typename std::iterator_traits<It>::value_type
+ */
+template <std::random_access_iterator It>
+constexpr auto percentile(It b, It e, double p) {
+    using value_t = typename std::iterator_traits<It>::value_type;
+    static_assert(std::is_arithmetic_v<value_t>);
+
+    if (b == e) return value_t{};
+
+    const double rank =
+        std::clamp(p, 0., 100.) / 100. * static_cast<double>(e - b - 1);
+    const auto lo = static_cast<size_t>(std::floor(rank));
+    const auto hi = static_cast<size_t>(std::ceil(rank));
+    const double lhs = static_cast<double>(b[lo]);
+    const double rhs = static_cast<double>(b[hi]);
+
+    return static_cast<value_t>(lhs + (rhs - lhs) * (rank - lo));
+}
+
 /**
  * @brief Finds left and right quartile of numeric range,
  * requires underlying container to be sorted
@@ -0,0 +1,522 @@
+#pragma once
+#ifndef MY_FLAT_MAP_HPP
+#define MY_FLAT_MAP_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace my {
+
+/**
+ * @brief Hasher for FlatMap, hashes anything convertible to std::string_view
+ * the same way so std::string keys can be looked up by std::string_view or
+ * c-string without constructing temporary key.
+ *
+ */
+struct FlatMapHash {
+    using is_transparent = void;
+
+    template <class T>
+    constexpr size_t operator()(const T& value) const {
+        if constexpr (std::convertible_to<const T&, std::string_view>) {
+            return std::hash<std::string_view>{}(value);
+        } else {
+            return std::hash<T>{}(value);
+        }
+    }
+};
+
+/**
+ * @brief Hashed vector adaptor with std::map like interface.
+ * All entries are stored in one contiguous buffer in insertion order, they
+ * are found through open addressing index of 32 bit positions, which is far
+ * more cache friendly than walking the nodes of red-black tree and needs
+ * single key comparison per lookup in most cases.
+ * Short std::string keys fit small string buffer thus stay inline with
+ * their values.
+ *
+ * Insertion is amortized O(1), erasure is O(n) as it preserves order,
+ * use erase_if to remove many entries at once in single pass.
+ * Any insertion or removal invalidates iterators and references.
+ * Entries are stored as std::pair<Key, Value> so growth and erasure move
+ * them, iterators yield std::pair<const Key&, Value&> proxy (as
+ * std::flat_map does), so keys can not be changed behind the index.
+ * Bind elements with auto&& or const auto&, not auto&.
+ *
+ * @note satisfies template <class, class> class Map parameter of my::Ini,
+ * iteration order is the order keys were first inserted in
+ *
+ * @tparam Key key type
+ * @tparam Value mapped type
+ * @tparam Hash transparent hasher
+ * @tparam KeyEqual transparent equality comparator
+ */
+template <class Key, class Value,
+          class Hash = FlatMapHash,
+          class KeyEqual = std::equal_to<>>
+class FlatMap {
+   public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<Key, Value>;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using container_type = std::vector<value_type>;
+    using size_type = typename container_type::size_type;
+    using difference_type = typename container_type::difference_type;
+    using reference = std::pair<const Key&, Value&>;
+    using const_reference = std::pair<const Key&, const Value&>;
+
+   private:
+    using _entry_t = std::pair<Key, Value>;
+
+    template <bool Const>
+    class _Iterator {
+        using entry_t = std::conditional_t<Const, const _entry_t, _entry_t>;
+
+       public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = _entry_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, FlatMap::const_reference,
+                                             FlatMap::reference>;
+
+        // operator-> has to return something, proxy is kept inside
+        struct pointer {
+            reference ref;
+            const reference* operator->() const noexcept { return &ref; }
+        };
+
+        _Iterator() = default;
+
+        template <bool Other>
+            requires(Const and not Other)
+        _Iterator(const _Iterator<Other>& other) noexcept
+            : _entry(other._entry) {
+        }
+
+        reference operator*() const noexcept {
+            return {_entry->first, _entry->second};
+        }
+        pointer operator->() const noexcept { return {**this}; }
+        reference operator[](difference_type n) const noexcept {
+            return *(*this + n);
+        }
+
+        _Iterator& operator++() noexcept { return ++_entry, *this; }
+        _Iterator& operator--() noexcept { return --_entry, *this; }
+        _Iterator operator++(int) noexcept { return _Iterator(_entry++); }
+        _Iterator operator--(int) noexcept { return _Iterator(_entry--); }
+        _Iterator& operator+=(difference_type n) noexcept {
+            return _entry += n, *this;
+        }
+        _Iterator& operator-=(difference_type n) noexcept {
+            return _entry -= n, *this;
+        }
+
+        friend _Iterator operator+(_Iterator it, difference_type n) noexcept {
+            return it += n;
+        }
+        friend _Iterator operator+(difference_type n, _Iterator it) noexcept {
+            return it += n;
+        }
+        friend _Iterator operator-(_Iterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+        friend difference_type operator-(const _Iterator& lhs,
+                                         const _Iterator& rhs) noexcept {
+            return lhs._entry - rhs._entry;
+        }
+        friend bool operator==(const _Iterator&, const _Iterator&) = default;
+        friend auto operator<=>(const _Iterator&, const _Iterator&) = default;
+
+       private:
+        friend class FlatMap;
+        friend class _Iterator<true>;
+
+        explicit _Iterator(entry_t* entry) noexcept : _entry(entry) {}
+
+        entry_t* _entry = nullptr;
+    };
+
+   public:
+    using iterator = _Iterator<false>;
+    using const_iterator = _Iterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    FlatMap() = default;
+
+    /**
+     * @brief Construct a new Flat Map object from initializer list.
+     * If key repeats only last value remains.
+     *
+     * @param list
+     */
+    FlatMap(std::initializer_list<value_type> list) {
+        reserve(list.size());
+        for (auto&& el : list) insert_or_assign(el.first, el.second);
+    }
+
+    // iterators
+
+    iterator begin() noexcept { return iterator(_data.data()); }
+    iterator end() noexcept { return begin() + size(); }
+    const_iterator begin() const noexcept {
+        return const_iterator(_data.data());
+    }
+    const_iterator end() const noexcept { return begin() + size(); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    // capacity
+
+    /**
+     * @brief Checks if the map has no elements
+     *
+     * @return true if the map is empty,
+     * @return false otherwise
+     */
+    [[nodiscard]] bool empty() const noexcept { return _data.empty(); }
+
+    /**
+     * @return The number of elements in the map.
+     */
+    size_type size() const noexcept { return _data.size(); }
+
+    /**
+     * @brief Attempts to preallocate enough memory for specified number of elements.
+     *
+     * @param size number of elements required.
+     */
+    void reserve(size_type size) {
+        _data.reserve(size);
+        _hashes.reserve(size);
+        if (_slotsFor(size) > _index.size()) _rehash(_slotsFor(size));
+    }
+
+    /**
+     * @brief Clears the map.
+     *
+     */
+    void clear() noexcept {
+        _data.clear();
+        _hashes.clear();
+        std::ranges::fill(_index, _empty);
+    }
+
+    // lookup
+
+    /**
+     * @brief Finds element with key equivalent to provided one
+     *
+     * @param key key or any value hashable and comparable with it
+     * @return iterator to element or end() if there is no such key
+     */
+    template <class K>
+    iterator find(const K& key) {
+        const auto position = _find(key, _hash(key));
+        return position == _empty ? end() : begin() + position;
+    }
+
+    template <class K>
+    const_iterator find(const K& key) const {
+        const auto position = _find(key, _hash(key));
+        return position == _empty ? end() : begin() + position;
+    }
+
+    template <class K>
+    bool contains(const K& key) const { return find(key) != end(); }
+
+    template <class K>
+    size_type count(const K& key) const { return contains(key); }
+
+    /**
+     * @brief Access element by key
+     * @note throws std::out_of_range if there is no such key
+     *
+     * @param key key or any value hashable and comparable with it
+     * @return Read/write reference to value
+     */
+    template <class K>
+    mapped_type& at(const K& key) {
+        auto it = find(key);
+        if (it == end()) throw std::out_of_range("FlatMap::at");
+        return it->second;
+    }
+
+    template <class K>
+    const mapped_type& at(const K& key) const {
+        auto it = find(key);
+        if (it == end()) throw std::out_of_range("FlatMap::at");
+        return it->second;
+    }
+
+    /**
+     * @brief Access element by key, inserts default constructed value
+     * if there were no such key
+     *
+     * @param key key or any value convertible to key_type
+     * @return Read/write reference to value
+     */
+    template <class K>
+        requires std::constructible_from<key_type, const K&>
+    mapped_type& operator[](const K& key) {
+        return try_emplace(key).first->second;
+    }
+
+    // modifiers
+
+    /**
+     * @brief Inserts value constructed from args if there is no such key
+     *
+     * @return pair of iterator to element and whether insertion took place
+     */
+    template <class K, class... Args>
+        requires std::constructible_from<key_type, K&&>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        const auto hash = _hash(key);
+        if (const auto position = _find(key, hash); position != _empty) {
+            return {begin() + position, false};
+        }
+
+        if (_slotsFor(_data.size() + 1) > _index.size()) {
+            _rehash(_slotsFor(_data.size() + 1));
+        }
+
+        _data.emplace_back(std::piecewise_construct,
+                           std::forward_as_tuple(std::forward<K>(key)),
+                           std::forward_as_tuple(std::forward<Args>(args)...));
+        _hashes.push_back(hash);
+        _place(hash, static_cast<index_t>(_data.size() - 1));
+
+        return {end() - 1, true};
+    }
+
+    /**
+     * @brief Inserts value or assigns it if key is already present
+     *
+     * @return pair of iterator to element and whether insertion took place
+     */
+    template <class K, class V>
+        requires std::constructible_from<key_type, K&&>
+    std::pair<iterator, bool> insert_or_assign(K&& key, V&& value) {
+        auto [it, inserted] = try_emplace(std::forward<K>(key),
+                                          std::forward<V>(value));
+        if (not inserted) it->second = std::forward<V>(value);
+        return {it, inserted};
+    }
+
+    /**
+     * @brief Inserts value if there is no such key
+     *
+     * @return pair of iterator to element and whether insertion took place
+     */
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return try_emplace(value.first, value.second);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return try_emplace(std::move(value.first), std::move(value.second));
+    }
+
+    /**
+     * @brief Removes element at position, preserving order of the rest
+     *
+     * @return iterator following removed element
+     */
+    iterator erase(const_iterator position) {
+        const auto offset = static_cast<index_t>(position - cbegin());
+
+        _unplace(offset);
+        _hashes.erase(_hashes.begin() + offset);
+        _data.erase(_data.begin() + offset);
+
+        // entries after removed one moved one position back
+        for (auto& slot : _index) {
+            if (slot != _empty and slot > offset) --slot;
+        }
+        return begin() + offset;
+    }
+
+    /**
+     * @brief Removes element with provided key
+     *
+     * @return amount of removed elements (0 or 1)
+     */
+    template <class K>
+        requires(not std::convertible_to<const K&, const_iterator>)
+    size_type erase(const K& key) {
+        auto it = find(key);
+        if (it == end()) return 0;
+        erase(const_iterator(it));
+        return 1;
+    }
+
+    /**
+     * @brief Removes all elements satisfying predicate, preserving order of
+     * the rest. Unlike repeated erase() entries are shifted and index
+     * is rebuilt only once.
+     * @note predicate is called exactly once for each element in order
+     *
+     * #Example:
+     * my::FlatMap<std::string, int> map{{"a", 1}, {"b", 2}};
+     * erase_if(map, [](auto&& entry) { return entry.second > 1; });
+     *
+     * @return amount of removed elements
+     */
+    template <class Pred>
+    friend size_type erase_if(FlatMap& map, Pred pred) {
+        size_type removed = 0;
+        try {
+            removed = map._compact(pred);
+        } catch (...) {
+            map._rehash(map._index.size());
+            throw;
+        }
+        if (removed) map._rehash(map._index.size());
+        return removed;
+    }
+
+    /**
+     * @brief Access to underlying vector of entries in insertion order
+     */
+    const container_type& data() const noexcept { return _data; }
+
+    /**
+     * @brief Gives away underlying vector of entries, so keys can be moved
+     * out as well, map is left empty
+     *
+     * #Example:
+     * for (auto&& [key, value] : std::move(map).extract()) { ... }
+     */
+    container_type extract() && {
+        container_type result = std::move(_data);
+        clear();
+        return result;
+    }
+
+    friend bool operator==(const FlatMap& lhs, const FlatMap& rhs) {
+        return lhs._data == rhs._data;
+    }
+
+   private:
+    using index_t = uint32_t;
+    static constexpr index_t _empty = ~index_t{};
+
+    template <class K>
+    size_t _hash(const K& key) const { return Hash{}(key); }
+
+    // index is kept at most half full, so probe sequences stay short
+    static constexpr size_t _slotsFor(size_t size) {
+        return size ? std::bit_ceil(size * 2) : 0;
+    }
+
+    template <class K>
+    index_t _find(const K& key, size_t hash) const {
+        if (_index.empty()) return _empty;
+
+        const size_t mask = _index.size() - 1;
+        for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+            const auto position = _index[slot];
+            if (position == _empty) return _empty;
+            if (_hashes[position] == hash and
+                KeyEqual{}(_data[position].first, key)) {
+                return position;
+            }
+        }
+    }
+
+    void _place(size_t hash, index_t position) {
+        const size_t mask = _index.size() - 1;
+        size_t slot = hash & mask;
+        while (_index[slot] != _empty) slot = (slot + 1) & mask;
+        _index[slot] = position;
+    }
+
+    // backward shift deletion of position from index, so probe sequences
+    // of the rest stay unbroken without tombstones
+    void _unplace(index_t position) noexcept {
+        const size_t mask = _index.size() - 1;
+        size_t slot = _hashes[position] & mask;
+        while (_index[slot] != position) slot = (slot + 1) & mask;
+
+        for (size_t next = (slot + 1) & mask; _index[next] != _empty;
+             next = (next + 1) & mask) {
+            // entry may fill the hole only if hole is not before its home
+            const size_t home = _hashes[_index[next]] & mask;
+            if (((next - home) & mask) >= ((next - slot) & mask)) {
+                _index[slot] = _index[next];
+                slot = next;
+            }
+        }
+        _index[slot] = _empty;
+    }
+
+    // removes entries matching predicate keeping order of the rest,
+    // index is left for caller to fix
+    template <class Pred>
+    size_type _compact(Pred&& pred) {
+        const size_type size = _data.size();
+        size_type kept = 0, i = 0;
+        auto relocate = [&] {
+            if (kept != i) {
+                _data[kept] = std::move(_data[i]);
+                _hashes[kept] = _hashes[i];
+            }
+            ++kept;
+        };
+
+        try {
+            for (; i < size; ++i) {
+                if (not pred(*(cbegin() + i))) relocate();
+            }
+        } catch (...) {
+            // entry the predicate threw on and the rest are kept
+            for (; i < size; ++i) relocate();
+            _truncate(kept);
+            throw;
+        }
+
+        _truncate(kept);
+        return size - kept;
+    }
+
+    void _truncate(size_type size) {
+        _data.erase(_data.begin() + size, _data.end());
+        _hashes.resize(size);
+    }
+
+    void _rehash(size_t slots) {
+        _index.assign(slots, _empty);
+        if (_index.empty()) return;
+        for (index_t i = 0; i < _hashes.size(); ++i) _place(_hashes[i], i);
+    }
+
+    container_type _data;
+    std::vector<size_t> _hashes;
+    std::vector<index_t> _index;
+};
+
+}  // namespace my
+
+#endif  // MY_FLAT_MAP_HPP